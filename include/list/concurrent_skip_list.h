@@ -0,0 +1,337 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef CONCURRENT_SKIP_LIST_H_
+#define CONCURRENT_SKIP_LIST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+
+#include "memory/epoch.h"
+
+/*
+ * Lock-free ordered set, after the skip list of Herlihy and Shavit. Every
+ * level is a linked list updated by compare-and-swap; the low bit of a
+ * link marks its owner as deleted at that level. remove() marks a node
+ * top-down and the mark on level 0 decides which remover wins; marked
+ * nodes are then unlinked by whichever thread walks past them.
+ *
+ * An inserter may still be linking the upper levels of a node that has
+ * already been removed, so the inserter and the remover each hold a claim
+ * on the node. Whoever drops the last claim unlinks the node from every
+ * level and retires it to the epoch reclaimer.
+ *
+ * find() never writes. size() is exact only when no update is running.
+ * Unlike SkipList there are no positional queries: spans cannot be kept
+ * consistent without locking.
+ */
+template <typename Tp, typename Compare = std::less<Tp>>
+class ConcurrentSkipList {
+public:
+  typedef Tp value_type;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+  typedef Compare value_compare;
+
+  explicit ConcurrentSkipList(const Compare& compare = Compare()) :
+    size_(0), compare_(compare) {
+    for (size_type i = 0; i < max_level; ++i) {
+      head_[i].store(0);
+    }
+  }
+  ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+  ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+  // Must not run concurrently with any other member function.
+  virtual ~ConcurrentSkipList() {
+    Node* node = to_node(head_[0].load());
+    while (node != nullptr) {
+      Node* next = to_node(node->links()[0].load());
+      destroy_node(node);
+      node = next;
+    }
+  }
+
+  bool empty() const { return size() == 0; }
+  size_type size() const {
+    std::ptrdiff_t size = size_.load();
+    return size > 0 ? static_cast<size_type>(size) : 0;
+  }
+
+  bool find(const value_type& value) const {
+    EpochGuard guard;
+    const Link* links = head_;
+    Node* current = nullptr;
+    for (size_type i = max_level; i-- > 0;) {
+      current = to_node(links[i].load());
+      while (current != nullptr) {
+        std::uintptr_t next = current->links()[i].load();
+        if (is_marked(next)) {
+          current = to_node(next);
+        } else if (compare_(current->value, value)) {
+          links = current->links();
+          current = to_node(next);
+        } else {
+          break;
+        }
+      }
+    }
+    return current != nullptr && !compare_(value, current->value);
+  }
+  // Returns false if an equivalent element is already present.
+  bool insert(const value_type& value) {
+    EpochGuard guard;
+    Link* preds[max_level];
+    Node* succs[max_level];
+    Node* node = nullptr;
+    while (true) {
+      if (search(value, preds, succs)) {
+        if (node != nullptr) {
+          destroy_node(node);
+        }
+        return false;
+      }
+      if (node == nullptr) {
+        node = create_node(random_height(), value);
+      }
+      for (size_type i = 0; i < node->height; ++i) {
+        node->links()[i].store(to_link(succs[i]));
+      }
+      std::uintptr_t expected = to_link(succs[0]);
+      if (preds[0]->compare_exchange_strong(expected, to_link(node))) {
+        break;
+      }
+    }
+    size_.fetch_add(1);
+    link_upper_levels(node, preds, succs);
+    release(node);
+    return true;
+  }
+  // Returns false if no equivalent element was present.
+  bool remove(const value_type& value) {
+    EpochGuard guard;
+    Link* preds[max_level];
+    Node* succs[max_level];
+    if (!search(value, preds, succs)) {
+      return false;
+    }
+    Node* node = succs[0];
+    for (size_type i = node->height; i-- > 1;) {
+      std::uintptr_t next = node->links()[i].load();
+      while (!is_marked(next) &&
+             !node->links()[i].compare_exchange_weak(next, next | 1)) {
+      }
+    }
+    std::uintptr_t next = node->links()[0].load();
+    while (true) {
+      if (is_marked(next)) {
+        return false;
+      }
+      if (node->links()[0].compare_exchange_weak(next, next | 1)) {
+        break;
+      }
+    }
+    size_.fetch_sub(1);
+    release(node);
+    return true;
+  }
+
+  // Visits the elements in order. Elements inserted or removed during the
+  // walk may or may not be seen.
+  template <typename Function>
+  void traverse(Function func) const {
+    EpochGuard guard;
+    Node* node = to_node(head_[0].load());
+    while (node != nullptr) {
+      std::uintptr_t next = node->links()[0].load();
+      if (!is_marked(next)) {
+        func(node->value);
+      }
+      node = to_node(next);
+    }
+  }
+
+protected:
+  static const size_type max_level = 32;
+  typedef std::atomic<std::uintptr_t> Link;
+
+  // The links of a node are allocated right behind it.
+  struct Node {
+    Node(size_type h, const Tp& x) : value(x), height(h), claims(2) {}
+    Link* links() { return reinterpret_cast<Link*>(this + 1); }
+    const Tp value;
+    const size_type height;
+    // Held by the inserter until its upper levels are linked and by the
+    // remover once it has marked the node.
+    std::atomic<int> claims;
+  };
+  static_assert(alignof(Node) >= alignof(Link),
+                "links must be aligned when placed behind a node");
+
+  static bool is_marked(std::uintptr_t link) { return (link & 1) != 0; }
+  static Node* to_node(std::uintptr_t link) {
+    return reinterpret_cast<Node*>(link & ~static_cast<std::uintptr_t>(1));
+  }
+  static std::uintptr_t to_link(Node* node) {
+    return reinterpret_cast<std::uintptr_t>(node);
+  }
+
+  static Node* create_node(size_type height, const Tp& value) {
+    void* memory = ::operator new(sizeof(Node) + height * sizeof(Link));
+    Node* node = nullptr;
+    try {
+      node = ::new (memory) Node(height, value);
+    } catch (...) {
+      ::operator delete(memory);
+      throw;
+    }
+    for (size_type i = 0; i < height; ++i) {
+      ::new (static_cast<void*>(&node->links()[i])) Link(0);
+    }
+    return node;
+  }
+  static void destroy_node(void* pointer) {
+    Node* node = static_cast<Node*>(pointer);
+    node->~Node();
+    ::operator delete(pointer);
+  }
+  static size_type random_height() {
+    static thread_local std::uint64_t seed =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    // xorshift64; two random bits per level give p = 1/4.
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    std::uint64_t bits = seed;
+    size_type height = 1;
+    while (height < max_level && (bits & 3) == 0) {
+      ++height;
+      bits >>= 2;
+    }
+    return height;
+  }
+
+  // Locates value on every level, unlinking marked nodes on the way.
+  // preds[i] is the level-i link to update and succs[i] the node it
+  // points to; returns true if succs[0] is an unmarked equivalent node.
+  bool search(const value_type& value, Link** preds, Node** succs) {
+  retry:
+    Link* links = head_;
+    for (size_type i = max_level; i-- > 0;) {
+      Node* current = to_node(links[i].load());
+      while (current != nullptr) {
+        std::uintptr_t next = current->links()[i].load();
+        if (is_marked(next)) {
+          std::uintptr_t expected = to_link(current);
+          if (!links[i].compare_exchange_strong(expected,
+                                                next & ~std::uintptr_t(1))) {
+            goto retry;
+          }
+          current = to_node(next);
+        } else if (compare_(current->value, value)) {
+          links = current->links();
+          current = to_node(next);
+        } else {
+          break;
+        }
+      }
+      preds[i] = &links[i];
+      succs[i] = current;
+    }
+    return succs[0] != nullptr && !compare_(value, succs[0]->value);
+  }
+  // Links levels 1 and up of a node already linked on level 0, giving up
+  // as soon as the node is found to be removed.
+  void link_upper_levels(Node* node, Link** preds, Node** succs) {
+    for (size_type i = 1; i < node->height; ++i) {
+      while (true) {
+        std::uintptr_t next = node->links()[i].load();
+        if (is_marked(next)) {
+          return;
+        }
+        if (to_node(next) != succs[i] &&
+            !node->links()[i].compare_exchange_strong(next,
+                                                      to_link(succs[i]))) {
+          continue;
+        }
+        std::uintptr_t expected = to_link(succs[i]);
+        if (preds[i]->compare_exchange_strong(expected, to_link(node))) {
+          break;
+        }
+        search(node->value, preds, succs);
+        if (succs[0] != node) {
+          return;
+        }
+      }
+    }
+  }
+  // Drops one claim. The last one unlinks the node from every level and
+  // retires it.
+  void release(Node* node) {
+    if (node->claims.fetch_sub(1) == 1) {
+      unlink(node);
+      Epoch::retire(node, &destroy_node);
+    }
+  }
+  // Snips a node whose links are all marked from every level. search()
+  // is not enough: it stops at the first unmarked equivalent node, and a
+  // later insert of an equivalent value may have linked its upper levels
+  // over this one. So each level is walked through the whole run of
+  // equivalent nodes. Once a pass finds the node nowhere, no link can
+  // point to it again: every writer of a link to it first has to see it.
+  void unlink(Node* node) {
+  retry:
+    Link* links = head_;
+    for (size_type i = max_level; i-- > 0;) {
+      Link* pred = &links[i];
+      Node* current = to_node(pred->load());
+      while (current != nullptr) {
+        std::uintptr_t next = current->links()[i].load();
+        if (is_marked(next)) {
+          std::uintptr_t expected = to_link(current);
+          if (!pred->compare_exchange_strong(expected,
+                                             next & ~std::uintptr_t(1))) {
+            goto retry;
+          }
+          current = to_node(next);
+        } else if (compare_(current->value, node->value)) {
+          links = current->links();
+          pred = &links[i];
+          current = to_node(next);
+        } else if (!compare_(node->value, current->value)) {
+          pred = &current->links()[i];
+          current = to_node(next);
+        } else {
+          break;
+        }
+      }
+    }
+  }
+
+  std::atomic<std::ptrdiff_t> size_;
+  Compare compare_;
+  Link head_[max_level];
+};
+
+#endif  // CONCURRENT_SKIP_LIST_H_
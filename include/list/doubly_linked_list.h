@@ -22,72 +22,136 @@
 #ifndef LIST_H_
 #define LIST_H_
 
+#include <cstddef>
+#include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
-template <typename Tp>
+#include "memory/node_pool.h"
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
 class List {
+protected:
+  struct Node;
+  template <typename Reference, typename Pointer>
+  class Iterator;
+
 public:
   typedef Tp value_type;
   typedef Tp& reference;
   typedef const Tp& const_reference;
   typedef std::size_t size_type;
+  typedef Iterator<Tp&, Tp*> iterator;
+  typedef Iterator<const Tp&, const Tp*> const_iterator;
+  typedef Alloc allocator_type;
 
   List() : size_(0), head_ptr_(nullptr), tail_ptr_(nullptr) {}
-  List(const List& other) : 
-    size_(other.size_), head_ptr_(nullptr), tail_ptr_(nullptr) {
+  explicit List(const Alloc& alloc) :
+    size_(0), head_ptr_(nullptr), tail_ptr_(nullptr), alloc_(alloc) {}
+  List(const List& other) :
+    size_(other.size_), head_ptr_(nullptr), tail_ptr_(nullptr),
+    alloc_(std::allocator_traits<NodeAllocator>::
+           select_on_container_copy_construction(other.alloc_)) {
     if (!other.empty()) {
       deep_copy(head_ptr_, tail_ptr_, other);
     }
   }
-  List(List&& other) : 
-    size_(std::move(other.size_)), head_ptr_(std::move(other.head_ptr_)), 
-    tail_ptr_(std::move(other.tail_ptr_)) {}
-  List(const std::initializer_list<value_type>& il) : 
-    size_(0), head_ptr_(nullptr), tail_ptr_(nullptr) {
-    size_type index = 0;
+  List(const List& other, const Alloc& alloc) :
+    size_(other.size_), head_ptr_(nullptr), tail_ptr_(nullptr),
+    alloc_(alloc) {
+    if (!other.empty()) {
+      deep_copy(head_ptr_, tail_ptr_, other);
+    }
+  }
+  List(List&& other) : size_(0), head_ptr_(nullptr), tail_ptr_(nullptr) {
+    swap(other);
+  }
+  List(const std::initializer_list<value_type>& il,
+       const Alloc& alloc = Alloc()) :
+    size_(0), head_ptr_(nullptr), tail_ptr_(nullptr), alloc_(alloc) {
     for (const value_type& element : il) {
-      insert(index, element);
-      ++index;
+      emplace_back(element);
     }
   }
+  // Copy assignment keeps this list's allocator; move assignment and swap
+  // exchange allocators along with the nodes.
   List& operator=(const List& rhs) {
-    size_type new_size = rhs.size_;
-    NodePtr new_head_ptr = nullptr, new_tail_ptr = nullptr;
-    if (!rhs.empty()) {
-      deep_copy(new_head_ptr, new_tail_ptr, rhs);
-    }
-    clear();
-    size_ = new_size;
-    head_ptr_ = new_head_ptr;
-    tail_ptr_ = new_tail_ptr;
+    List copy(rhs, get_allocator());
+    swap(copy);
     return *this;
   }
   List& operator=(List&& rhs) {
-    size_ = std::move(rhs.size_);
-    head_ptr_ = std::move(rhs.head_ptr_);
-    tail_ptr_ = std::move(rhs.tail_ptr_);
+    swap(rhs);
     return *this;
   }
   List& operator=(const std::initializer_list<value_type>& il) {
     clear();
-    size_type index = 0;
     for (const value_type& element : il) {
-      insert(index, element);
-      ++index;
+      emplace_back(element);
     }
     return *this;
   }
-  virtual ~List() {}
+  virtual ~List() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const { return allocator_type(alloc_); }
   void clear() {
+    if (head_ptr_ != nullptr) {
+      NodePool<Node, NodeAllocator>& nodes = pool();
+      if (pool_.use_count() == 1) {
+        nodes.destroy_all(head_ptr_, &Node::next);
+      } else {
+        // Other lists allocate from the same pool; free only our nodes.
+        while (head_ptr_ != nullptr) {
+          NodePtr next_ptr = head_ptr_->next;
+          nodes.destroy(head_ptr_);
+          head_ptr_ = next_ptr;
+        }
+      }
+    }
     size_ = 0;
     head_ptr_ = nullptr;
     tail_ptr_ = nullptr;
+    leave_shared_pool();
+  }
+  void swap(List& other) {
+    std::swap(size_, other.size_);
+    std::swap(head_ptr_, other.head_ptr_);
+    std::swap(tail_ptr_, other.tail_ptr_);
+    std::swap(pool_, other.pool_);
+    swap_allocators(alloc_, other.alloc_);
+  }
+
+  iterator begin() { return iterator(head_ptr_, this); }
+  const_iterator begin() const {
+    return const_iterator(head_ptr_, this);
+  }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(nullptr, this); }
+  const_iterator end() const { return const_iterator(nullptr, this); }
+  const_iterator cend() const { return end(); }
+
+  reference front() {
+    require_nonempty("List::front()");
+    return head_ptr_->value;
+  }
+  const_reference front() const {
+    require_nonempty("List::front()");
+    return head_ptr_->value;
+  }
+  reference back() {
+    require_nonempty("List::back()");
+    return tail_ptr_->value;
+  }
+  const_reference back() const {
+    require_nonempty("List::back()");
+    return tail_ptr_->value;
   }
 
   const_reference retrieve(const size_type& index) const {
@@ -103,90 +167,395 @@ public:
   value_type remove(const size_type& index) {
     require_nonempty("List::remove()");
     check_range_inclusive_exclusive(index);
-    value_type removed_value = value_type();
-    if (size_ == 1) {
-      removed_value = head_ptr_->value;
-      head_ptr_ = nullptr;
-      tail_ptr_ = nullptr;
-    } else {
-      if (index == 0) {
-        removed_value = head_ptr_->value;
-        head_ptr_ = head_ptr_->next;
-        head_ptr_->prev.reset();
-      } else if (index == size_ - 1) {
-        removed_value = tail_ptr_->value;
-        tail_ptr_ = tail_ptr_->prev.lock();
-        tail_ptr_->next = nullptr;
-      } else {
-        NodePtr rm_ptr = to_node_ptr(index);
-        rm_ptr->next->prev = rm_ptr->prev;
-        rm_ptr->prev.lock()->next = rm_ptr->next;
-      }
-    }
-    --size_;
+    NodePtr rm_ptr = to_node_ptr(index);
+    value_type removed_value = std::move(rm_ptr->value);
+    unlink(rm_ptr);
     return removed_value;
   }
   void insert(const size_type& index, const value_type& value) {
     check_range_inclusive_inclusive(index);
-    NodePtr new_ptr = std::make_shared<Node>(value);
-    if (size_ == 0) {
-      head_ptr_ = new_ptr;
-      tail_ptr_ = new_ptr;
-    } else {
-      if (index == 0) {
-        new_ptr->next = head_ptr_;
-        head_ptr_->prev = new_ptr;
-        head_ptr_ = new_ptr;
-      } else if (index == size_) {
-        tail_ptr_->next = new_ptr;
-        new_ptr->prev = tail_ptr_;
-        tail_ptr_ = new_ptr;
+    link_before(index == size_ ? nullptr : to_node_ptr(index),
+                pool().create(value));
+  }
+
+  // O(1) edits through iterators; iterators to other elements stay valid.
+  template <typename... Args>
+  iterator emplace(const_iterator position, Args&&... args) {
+    NodePtr new_ptr = pool().create(std::forward<Args>(args)...);
+    link_before(position.node_, new_ptr);
+    return iterator(new_ptr, this);
+  }
+  iterator insert(const_iterator position, const value_type& value) {
+    return emplace(position, value);
+  }
+  iterator insert(const_iterator position, value_type&& value) {
+    return emplace(position, std::move(value));
+  }
+  iterator insert_after(const_iterator position, const value_type& value) {
+    return emplace(std::next(position), value);
+  }
+  iterator insert_after(const_iterator position, value_type&& value) {
+    return emplace(std::next(position), std::move(value));
+  }
+  // Returns the iterator following the removed element.
+  iterator erase(const_iterator position) {
+    if (position.node_ == nullptr) {
+      throw std::out_of_range("List::erase() is undefined for end().");
+    }
+    Node* next_node = position.node_->next;
+    unlink(position.node_);
+    return iterator(next_node, this);
+  }
+  template <typename... Args>
+  reference emplace_front(Args&&... args) {
+    return *emplace(begin(), std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+  void push_front(const value_type& value) { emplace_front(value); }
+  void push_front(value_type&& value) { emplace_front(std::move(value)); }
+  void push_back(const value_type& value) { emplace_back(value); }
+  void push_back(value_type&& value) { emplace_back(std::move(value)); }
+  void pop_front() {
+    require_nonempty("List::pop_front()");
+    unlink(head_ptr_);
+  }
+  void pop_back() {
+    require_nonempty("List::pop_back()");
+    unlink(tail_ptr_);
+  }
+
+  // Splicing moves nodes between lists without copying or moving any
+  // element, and iterators to the moved elements stay valid. Lists that
+  // exchange nodes end up allocating from one shared node pool, so they
+  // must have equal allocators; std::invalid_argument is thrown otherwise.
+  // The pool is not thread-safe: until one of them becomes empty, such
+  // lists may not be modified from different threads even though they look
+  // independent, and the pool's memory is kept until the last of them is
+  // destroyed or emptied. A list leaves the shared pool once it is empty.
+  void splice(const_iterator position, List& other) {
+    if (&other == this || other.empty()) {
+      return;
+    }
+    share_pool(other, "List::splice()");
+    NodePtr first = other.head_ptr_, last = other.tail_ptr_;
+    other.detach(first, last);
+    attach(position.node_, first, last);
+    size_ += other.size_;
+    other.size_ = 0;
+    other.leave_shared_pool();
+  }
+  void splice(const_iterator position, List&& other) {
+    splice(position, other);
+  }
+  void splice(const_iterator position, List& other, const_iterator it) {
+    NodePtr node = it.node_;
+    if (&other == this &&
+        (node == position.node_ || node->next == position.node_)) {
+      return;
+    }
+    share_pool(other, "List::splice()");
+    other.detach(node, node);
+    attach(position.node_, node, node);
+    --other.size_;
+    ++size_;
+    other.leave_shared_pool();
+  }
+  // Constant time within one list. Between two lists the range has to be
+  // counted to keep both sizes, which is linear in its length.
+  void splice(const_iterator position, List& other,
+              const_iterator first, const_iterator last) {
+    if (first == last) {
+      return;
+    }
+    NodePtr first_node = first.node_;
+    NodePtr last_node = last.node_ == nullptr ?
+                        other.tail_ptr_ : last.node_->prev;
+    if (&other != this) {
+      size_type count = 1;
+      for (NodePtr node = first_node; node != last_node; node = node->next) {
+        ++count;
+      }
+      share_pool(other, "List::splice()");
+      other.size_ -= count;
+      size_ += count;
+    }
+    other.detach(first_node, last_node);
+    attach(position.node_, first_node, last_node);
+    other.leave_shared_pool();
+  }
+
+  // Merges the sorted other into this sorted list by relinking its nodes,
+  // leaving other empty. Equivalent elements of this list stay in front.
+  void merge(List& other) { merge(other, std::less<value_type>()); }
+  void merge(List&& other) { merge(other); }
+  template <typename Compare>
+  void merge(List& other, Compare comp) {
+    if (&other == this || other.empty()) {
+      return;
+    }
+    share_pool(other, "List::merge()");
+    NodePtr mine = head_ptr_;
+    while (other.head_ptr_ != nullptr) {
+      if (mine == nullptr) {
+        NodePtr first = other.head_ptr_, last = other.tail_ptr_;
+        other.detach(first, last);
+        attach(nullptr, first, last);
+      } else if (comp(other.head_ptr_->value, mine->value)) {
+        // Moves the whole run of other that goes in front of mine.
+        NodePtr first = other.head_ptr_, last = first;
+        while (last->next != nullptr && comp(last->next->value, mine->value)) {
+          last = last->next;
+        }
+        other.detach(first, last);
+        attach(mine, first, last);
       } else {
-        NodePtr prev_ptr = to_node_ptr(index - 1), next_ptr = prev_ptr->next;
-        prev_ptr->next = new_ptr;
-        new_ptr->next = next_ptr;
-        next_ptr->prev = new_ptr;
-        new_ptr->prev = prev_ptr;
+        mine = mine->next;
       }
     }
-    ++size_;
+    size_ += other.size_;
+    other.size_ = 0;
+    other.leave_shared_pool();
   }
-  void traverse(void (*f)(value_type&)) {
-    NodePtr traverse_ptr = head_ptr_;
-    while (traverse_ptr != nullptr) {
-      (*f)(traverse_ptr->value);
-      traverse_ptr = traverse_ptr->next;
+  template <typename Compare>
+  void merge(List&& other, Compare comp) { merge(other, comp); }
+
+  // Stable bottom-up merge sort that relinks nodes: no element is copied
+  // or moved and no memory is allocated. Runs of width 1, 2, 4, ... are
+  // merged along the next links, and the prev links are rebuilt at the end.
+  void sort() { sort(std::less<value_type>()); }
+  template <typename Compare>
+  void sort(Compare comp) {
+    if (size_ < 2) {
+      return;
+    }
+    NodePtr sorted = head_ptr_;
+    for (size_type width = 1; ; width *= 2) {
+      NodePtr left = sorted, tail = nullptr;
+      sorted = nullptr;
+      size_type merges = 0;
+      while (left != nullptr) {
+        ++merges;
+        NodePtr right = left;
+        size_type left_size = 0, right_size = width;
+        while (left_size < width && right != nullptr) {
+          ++left_size;
+          right = right->next;
+        }
+        while (left_size > 0 || (right_size > 0 && right != nullptr)) {
+          NodePtr next_ptr = nullptr;
+          if (left_size > 0 &&
+              (right_size == 0 || right == nullptr ||
+               !comp(right->value, left->value))) {
+            next_ptr = left;
+            left = left->next;
+            --left_size;
+          } else {
+            next_ptr = right;
+            right = right->next;
+            --right_size;
+          }
+          if (tail == nullptr) {
+            sorted = next_ptr;
+          } else {
+            tail->next = next_ptr;
+          }
+          tail = next_ptr;
+        }
+        left = right;
+      }
+      tail->next = nullptr;
+      if (merges == 1) {
+        break;
+      }
+    }
+    head_ptr_ = sorted;
+    NodePtr prev_ptr = nullptr;
+    for (NodePtr node = sorted; node != nullptr; node = node->next) {
+      node->prev = prev_ptr;
+      prev_ptr = node;
+    }
+    tail_ptr_ = prev_ptr;
+  }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for (Node* node = head_ptr_; node != nullptr;
+         node = node->next) {
+      func(node->value);
+    }
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for (const Node* node = head_ptr_; node != nullptr;
+         node = node->next) {
+      func(node->value);
     }
   }
 
 protected:
-  struct Node;
-  typedef std::shared_ptr<Node> NodePtr;
+  typedef Node* NodePtr;
   struct Node {
-    Node() : value(value_type()), prev(std::weak_ptr<Node>()), next(nullptr) {}
-    explicit Node(const value_type& x) : value(x), 
-      prev(std::weak_ptr<Node>()), next(nullptr) {}
-    explicit Node(value_type&& x) : value(std::move(x)), 
-      prev(std::weak_ptr<Node>()), next(nullptr) {}
+    Node() : value(value_type()), prev(nullptr), next(nullptr) {}
+    template <typename... Args>
+    explicit Node(Args&&... args) : value(std::forward<Args>(args)...),
+      prev(nullptr), next(nullptr) {}
     Tp value;
-    std::weak_ptr<Node> prev;
+    NodePtr prev;
     NodePtr next;
   };
+  // Node pool shared by every list that has exchanged nodes with this one.
+  // When two pools meet, one is merged into the other and keeps a link to
+  // it, so lists still holding the old pool find the merged one.
+  typedef typename std::allocator_traits<Alloc>::template
+    rebind_alloc<Node> NodeAllocator;
+  struct SharedPool {
+    explicit SharedPool(const NodeAllocator& alloc) : nodes(alloc) {}
+    NodePool<Node, NodeAllocator> nodes;
+    std::shared_ptr<SharedPool> merged_into;
+  };
+
+  template <typename Reference, typename Pointer>
+  class Iterator {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Tp value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Pointer pointer;
+    typedef Reference reference;
+
+    Iterator() : node_(nullptr), list_(nullptr) {}
+    // Allows iterator to const_iterator conversion, but not the reverse.
+    template <typename OtherReference, typename OtherPointer,
+              typename = typename std::enable_if<
+                std::is_convertible<OtherPointer, Pointer>::value>::type>
+    Iterator(const Iterator<OtherReference, OtherPointer>& other) :
+      node_(other.node_), list_(other.list_) {}
+
+    reference operator*() const { return node_->value; }
+    pointer operator->() const { return &node_->value; }
+    Iterator& operator++() {
+      node_ = node_->next;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    // Decrementing end() yields the last element.
+    Iterator& operator--() {
+      node_ = node_ == nullptr ? list_->tail_ptr_ : node_->prev;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator old = *this;
+      --*this;
+      return old;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator==(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ == rhs.node_;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator!=(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ != rhs.node_;
+    }
+
+  private:
+    friend class List;
+    template <typename, typename> friend class Iterator;
+    Iterator(Node* node, const List* list) : node_(node), list_(list) {}
+    Node* node_;
+    const List* list_;
+  };
 
-  void deep_copy(NodePtr& new_head_ptr, NodePtr& new_tail_ptr, 
+  NodePool<Node, NodeAllocator>& pool() {
+    if (pool_ == nullptr) {
+      pool_ = std::allocate_shared<SharedPool>(alloc_, alloc_);
+    }
+    while (pool_->merged_into != nullptr) {
+      pool_ = pool_->merged_into;
+    }
+    return pool_->nodes;
+  }
+  // Makes this list and other allocate from, and free to, the same pool.
+  void share_pool(List& other, const std::string& function_name) {
+    if (!(alloc_ == other.alloc_)) {
+      throw std::invalid_argument(
+        function_name + " is undefined for lists with unequal allocators.");
+    }
+    NodePool<Node, NodeAllocator>& nodes = pool();
+    other.pool();
+    if (pool_ != other.pool_) {
+      nodes.merge(other.pool_->nodes);
+      other.pool_->merged_into = pool_;
+      other.pool_ = pool_;
+    }
+  }
+  // An empty list holds no node of a pool it shares, so it lets go of the
+  // pool and creates a private one on next use.
+  void leave_shared_pool() {
+    if (head_ptr_ == nullptr && pool_ != nullptr && pool_.use_count() > 1) {
+      pool_.reset();
+    }
+  }
+  void deep_copy(NodePtr& new_head_ptr, NodePtr& new_tail_ptr,
                  const List& other) {
-    new_head_ptr = std::make_shared<Node>(other.head_ptr_->value);
+    new_head_ptr = pool().create(other.head_ptr_->value);
     NodePtr copy_ptr = new_head_ptr, other_ptr = other.head_ptr_;
     while (other_ptr->next != nullptr) {
       other_ptr = other_ptr->next;
-      copy_ptr->next = std::make_shared<Node>(other_ptr->value);
+      copy_ptr->next = pool().create(other_ptr->value);
       copy_ptr->next->prev = copy_ptr;
       copy_ptr = copy_ptr->next;
     }
     new_tail_ptr = copy_ptr;
   }
+  // Links the chain first..last in front of next_ptr, or at the back if
+  // next_ptr is null. Neither attach() nor detach() touches size_.
+  void attach(NodePtr next_ptr, NodePtr first, NodePtr last) {
+    NodePtr prev_ptr = next_ptr == nullptr ? tail_ptr_ : next_ptr->prev;
+    first->prev = prev_ptr;
+    last->next = next_ptr;
+    if (prev_ptr == nullptr) {
+      head_ptr_ = first;
+    } else {
+      prev_ptr->next = first;
+    }
+    if (next_ptr == nullptr) {
+      tail_ptr_ = last;
+    } else {
+      next_ptr->prev = last;
+    }
+  }
+  void detach(NodePtr first, NodePtr last) {
+    NodePtr prev_ptr = first->prev, next_ptr = last->next;
+    if (next_ptr == nullptr) {
+      tail_ptr_ = prev_ptr;
+    } else {
+      next_ptr->prev = prev_ptr;
+    }
+    if (prev_ptr == nullptr) {
+      head_ptr_ = next_ptr;
+    } else {
+      prev_ptr->next = next_ptr;
+    }
+  }
+  void link_before(NodePtr next_ptr, NodePtr new_ptr) {
+    attach(next_ptr, new_ptr, new_ptr);
+    ++size_;
+  }
+  void unlink(NodePtr rm_ptr) {
+    detach(rm_ptr, rm_ptr);
+    pool().destroy(rm_ptr);
+    --size_;
+    leave_shared_pool();
+  }
   NodePtr to_node_ptr(const size_type& index) const {
-    NodePtr iter_ptr;
+    NodePtr iter_ptr = nullptr;
     if (index <= static_cast<size_type>(size_ / 2)) {
       iter_ptr = head_ptr_;
       for (size_type i = 0; i < index; ++i) {
@@ -194,8 +563,8 @@ protected:
       }
     } else {
       iter_ptr = tail_ptr_;
-      for (size_type i = size_ - 1; i > index; --i) { 
-        iter_ptr = iter_ptr->prev.lock();
+      for (size_type i = size_ - 1; i > index; --i) {
+        iter_ptr = iter_ptr->prev;
       }
     }
     return iter_ptr;
@@ -205,11 +574,11 @@ protected:
       throw std::out_of_range(
         function_name + " is undefined when the stack is empty.");
     }
-  }  
+  }
   void check_range_inclusive_exclusive(const size_type& index) const {
     if (!(index >= 0 && index <= size_ - 1)) {
       throw std::out_of_range(
-        "List range check failed: " + 
+        "List range check failed: " +
         std::to_string(index) + " is out of the range [0, " +
         std::to_string(size_) + ").");
     }
@@ -217,7 +586,7 @@ protected:
   void check_range_inclusive_inclusive(const size_type& index) const {
     if (!(index >= 0 && index <= size_)) {
       throw std::out_of_range(
-        "List range check failed: " + 
+        "List range check failed: " +
         std::to_string(index) + " is out of the range [0, " +
         std::to_string(size_) + "].");
     }
@@ -226,6 +595,9 @@ protected:
   size_type size_;
   NodePtr head_ptr_;
   NodePtr tail_ptr_;
+  // Created on first use.
+  std::shared_ptr<SharedPool> pool_;
+  NodeAllocator alloc_;
 };
 
-#endif  // LIST_H_
\ No newline at end of file
+#endif  // LIST_H_
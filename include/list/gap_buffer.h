@@ -0,0 +1,280 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef GAP_BUFFER_H_
+#define GAP_BUFFER_H_
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Array-backed list with the retrieve/replace/insert/remove interface of
+ * the static List, for edits that cluster around a cursor. The free space
+ * is kept as one gap inside the array; an edit first moves the gap to the
+ * edit position, shifting only the elements between the old and the new
+ * position, and then fills or widens the gap in O(1).
+ *
+ * Trivially copyable elements are shifted with a single memmove. The
+ * array doubles when the gap is used up.
+ */
+template <typename Tp>
+class GapBuffer {
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+
+  GapBuffer() :
+    data_(nullptr), capacity_(0), gap_begin_(0), gap_end_(0) {}
+  explicit GapBuffer(size_type capacity) :
+    data_(allocate(capacity)), capacity_(capacity), gap_begin_(0),
+    gap_end_(capacity) {}
+  GapBuffer(const GapBuffer& other) :
+    data_(allocate(other.size())), capacity_(other.size()), gap_begin_(0),
+    gap_end_(other.size()) {
+    for (size_type i = 0; i < other.size(); ++i) {
+      ::new (static_cast<void*>(data_ + gap_begin_)) Tp(other[i]);
+      ++gap_begin_;
+    }
+  }
+  GapBuffer(GapBuffer&& other) :
+    data_(nullptr), capacity_(0), gap_begin_(0), gap_end_(0) {
+    swap(other);
+  }
+  GapBuffer(const std::initializer_list<value_type>& il) :
+    data_(allocate(il.size())), capacity_(il.size()), gap_begin_(0),
+    gap_end_(il.size()) {
+    for (const value_type& element : il) {
+      ::new (static_cast<void*>(data_ + gap_begin_)) Tp(element);
+      ++gap_begin_;
+    }
+  }
+  GapBuffer& operator=(const GapBuffer& rhs) {
+    GapBuffer copy(rhs);
+    swap(copy);
+    return *this;
+  }
+  GapBuffer& operator=(GapBuffer&& rhs) {
+    swap(rhs);
+    return *this;
+  }
+  virtual ~GapBuffer() {
+    clear();
+    ::operator delete(static_cast<void*>(data_));
+  }
+
+  bool empty() const { return size() == 0; }
+  size_type size() const { return capacity_ - (gap_end_ - gap_begin_); }
+  size_type capacity() const { return capacity_; }
+  void clear() {
+    destroy(data_, data_ + gap_begin_);
+    destroy(data_ + gap_end_, data_ + capacity_);
+    gap_begin_ = 0;
+    gap_end_ = capacity_;
+  }
+  void reserve(size_type new_capacity) {
+    if (new_capacity > capacity_) {
+      reallocate(new_capacity);
+    }
+  }
+  void swap(GapBuffer& other) {
+    std::swap(data_, other.data_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(gap_begin_, other.gap_begin_);
+    std::swap(gap_end_, other.gap_end_);
+  }
+
+  reference operator[](size_type index) { return data_[physical(index)]; }
+  const_reference operator[](size_type index) const {
+    return data_[physical(index)];
+  }
+  const_reference retrieve(const size_type& index) const {
+    require_nonempty("GapBuffer::retrieve()");
+    check_range_inclusive_exclusive(index);
+    return (*this)[index];
+  }
+  void replace(const size_type& index, const value_type& value) {
+    require_nonempty("GapBuffer::replace()");
+    check_range_inclusive_exclusive(index);
+    (*this)[index] = value;
+  }
+  value_type remove(const size_type& index) {
+    require_nonempty("GapBuffer::remove()");
+    check_range_inclusive_exclusive(index);
+    move_gap(index);
+    Tp* target = data_ + gap_end_;
+    value_type removed_value = std::move(*target);
+    target->~Tp();
+    ++gap_end_;
+    return removed_value;
+  }
+  void insert(const size_type& index, const value_type& value) {
+    check_range_inclusive_inclusive(index);
+    emplace(index, value);
+  }
+  void insert(const size_type& index, value_type&& value) {
+    check_range_inclusive_inclusive(index);
+    emplace(index, std::move(value));
+  }
+  template <typename... Args>
+  reference emplace(size_type index, Args&&... args) {
+    // Built up front: the arguments may refer to elements that are about
+    // to be shifted.
+    Tp value(std::forward<Args>(args)...);
+    if (gap_begin_ == gap_end_) {
+      reallocate(capacity_ < 8 ? 16 : 2 * capacity_);
+    }
+    move_gap(index);
+    Tp* target = data_ + gap_begin_;
+    ::new (static_cast<void*>(target)) Tp(std::move(value));
+    ++gap_begin_;
+    return *target;
+  }
+  void push_back(const value_type& value) { emplace(size(), value); }
+  void push_back(value_type&& value) { emplace(size(), std::move(value)); }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for (size_type i = 0; i < gap_begin_; ++i) {
+      func(data_[i]);
+    }
+    for (size_type i = gap_end_; i < capacity_; ++i) {
+      func(data_[i]);
+    }
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for (size_type i = 0; i < gap_begin_; ++i) {
+      func(data_[i]);
+    }
+    for (size_type i = gap_end_; i < capacity_; ++i) {
+      func(data_[i]);
+    }
+  }
+
+protected:
+  static Tp* allocate(size_type capacity) {
+    return static_cast<Tp*>(::operator new(capacity * sizeof(Tp)));
+  }
+  static void destroy(Tp* first, Tp* last) {
+    for (; first != last; ++first) {
+      first->~Tp();
+    }
+  }
+  size_type physical(size_type index) const {
+    return index < gap_begin_ ? index : index + (gap_end_ - gap_begin_);
+  }
+
+  // Moves the gap so that it starts at index, shifting the elements in
+  // between to the other side of it.
+  void move_gap(size_type index) {
+    if (gap_begin_ == gap_end_) {
+      gap_begin_ = gap_end_ = index;
+    } else if (index < gap_begin_) {
+      size_type count = gap_begin_ - index;
+      relocate(data_ + index, data_ + gap_end_ - count, count);
+      gap_begin_ = index;
+      gap_end_ -= count;
+    } else if (index > gap_begin_) {
+      size_type count = index - gap_begin_;
+      relocate(data_ + gap_end_, data_ + gap_begin_, count);
+      gap_begin_ += count;
+      gap_end_ += count;
+    }
+  }
+  // Moves count elements from source to the uninitialized slots at target.
+  // The two ranges may overlap, but target never lies inside the live
+  // part of source that is yet to be moved.
+  static void relocate(Tp* source, Tp* target, size_type count) {
+    relocate(source, target, count, std::is_trivially_copyable<Tp>());
+  }
+  static void relocate(Tp* source, Tp* target, size_type count,
+                       std::true_type) {
+    if (count > 0) {
+      std::memmove(static_cast<void*>(target), static_cast<void*>(source),
+                   count * sizeof(Tp));
+    }
+  }
+  static void relocate(Tp* source, Tp* target, size_type count,
+                       std::false_type) {
+    if (target > source) {
+      for (size_type i = count; i-- > 0;) {
+        ::new (static_cast<void*>(target + i)) Tp(std::move(source[i]));
+        source[i].~Tp();
+      }
+    } else {
+      for (size_type i = 0; i < count; ++i) {
+        ::new (static_cast<void*>(target + i)) Tp(std::move(source[i]));
+        source[i].~Tp();
+      }
+    }
+  }
+  // Keeps the gap where it is, widening it to fill the new capacity.
+  void reallocate(size_type new_capacity) {
+    Tp* new_data = allocate(new_capacity);
+    size_type tail = capacity_ - gap_end_;
+    size_type new_gap_end = new_capacity - tail;
+    relocate(data_, new_data, gap_begin_);
+    relocate(data_ + gap_end_, new_data + new_gap_end, tail);
+    ::operator delete(static_cast<void*>(data_));
+    data_ = new_data;
+    capacity_ = new_capacity;
+    gap_end_ = new_gap_end;
+  }
+
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the list is empty.");
+    }
+  }
+  void check_range_inclusive_exclusive(const size_type& index) const {
+    if (index >= size()) {
+      throw std::out_of_range(
+        "GapBuffer range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size()) + ").");
+    }
+  }
+  void check_range_inclusive_inclusive(const size_type& index) const {
+    if (index > size()) {
+      throw std::out_of_range(
+        "GapBuffer range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size()) + "].");
+    }
+  }
+
+  Tp* data_;
+  size_type capacity_;
+  // The gap is the uninitialized slots [gap_begin_, gap_end_).
+  size_type gap_begin_;
+  size_type gap_end_;
+};
+
+#endif  // GAP_BUFFER_H_
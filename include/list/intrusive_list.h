@@ -0,0 +1,295 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef INTRUSIVE_LIST_H_
+#define INTRUSIVE_LIST_H_
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Links embedded in an object so that it can be put on an IntrusiveList.
+// An object has one hook per list it may be on at the same time. Copying
+// an object does not copy its membership.
+struct IntrusiveListHook {
+  IntrusiveListHook() : prev(nullptr), next(nullptr) {}
+  IntrusiveListHook(const IntrusiveListHook&) :
+    prev(nullptr), next(nullptr) {}
+  IntrusiveListHook& operator=(const IntrusiveListHook&) { return *this; }
+
+  bool is_linked() const { return next != nullptr; }
+
+  IntrusiveListHook* prev;
+  IntrusiveListHook* next;
+};
+
+/*
+ * Doubly linked list of objects that carry their own links. The list
+ * neither allocates nor owns anything: push and insert link the object
+ * through its hook, and erase(object) unlinks it in O(1) without a search.
+ *
+ * The list is circular around a hook inside the list object itself, so
+ * linking and unlinking never test for the ends. An object must be erased
+ * before it is destroyed, and may be on only one list per hook.
+ */
+template <typename Tp, IntrusiveListHook Tp::*hook>
+class IntrusiveList {
+protected:
+  template <typename Reference, typename Pointer>
+  class Iterator;
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+  typedef Iterator<Tp&, Tp*> iterator;
+  typedef Iterator<const Tp&, const Tp*> const_iterator;
+
+  IntrusiveList() : size_(0) { reset(); }
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList(IntrusiveList&& other) : size_(0) {
+    reset();
+    swap(other);
+  }
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(IntrusiveList&& rhs) {
+    clear();
+    swap(rhs);
+    return *this;
+  }
+  virtual ~IntrusiveList() { clear(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  // Unlinks every object; none is destroyed.
+  void clear() {
+    IntrusiveListHook* node = head_.next;
+    while (node != &head_) {
+      IntrusiveListHook* next = node->next;
+      node->prev = nullptr;
+      node->next = nullptr;
+      node = next;
+    }
+    size_ = 0;
+    reset();
+  }
+  // The ends point back at the list object, so they are re-aimed rather
+  // than exchanged.
+  void swap(IntrusiveList& other) {
+    IntrusiveListHook* first = head_.next;
+    IntrusiveListHook* last = head_.prev;
+    size_type size = size_;
+    take(other.head_.next, other.head_.prev, other.size_);
+    other.take(first, last, size);
+  }
+
+  iterator begin() { return iterator(head_.next); }
+  const_iterator begin() const { return const_iterator(head_.next); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(&head_); }
+  const_iterator end() const { return const_iterator(&head_); }
+  const_iterator cend() const { return end(); }
+  iterator iterator_to(reference object) { return iterator(&(object.*hook)); }
+  const_iterator iterator_to(const_reference object) const {
+    return const_iterator(&(object.*hook));
+  }
+
+  reference front() {
+    require_nonempty("IntrusiveList::front()");
+    return *to_object(head_.next);
+  }
+  const_reference front() const {
+    require_nonempty("IntrusiveList::front()");
+    return *to_object(head_.next);
+  }
+  reference back() {
+    require_nonempty("IntrusiveList::back()");
+    return *to_object(head_.prev);
+  }
+  const_reference back() const {
+    require_nonempty("IntrusiveList::back()");
+    return *to_object(head_.prev);
+  }
+
+  void push_front(reference object) { link_before(head_.next, object); }
+  void push_back(reference object) { link_before(&head_, object); }
+  void pop_front() {
+    require_nonempty("IntrusiveList::pop_front()");
+    unlink(head_.next);
+  }
+  void pop_back() {
+    require_nonempty("IntrusiveList::pop_back()");
+    unlink(head_.prev);
+  }
+  // Links object in front of position.
+  iterator insert(const_iterator position, reference object) {
+    link_before(position.node_, object);
+    return iterator_to(object);
+  }
+  // Unlinks the object at position and returns the position after it.
+  iterator erase(const_iterator position) {
+    IntrusiveListHook* next = position.node_->next;
+    unlink(position.node_);
+    return iterator(next);
+  }
+  // Unlinks object, which must be on this list.
+  void erase(reference object) { unlink(&(object.*hook)); }
+  // Moves object, which must be on this list, in front of position.
+  void splice(const_iterator position, reference object) {
+    IntrusiveListHook* node = &(object.*hook);
+    if (node != position.node_) {
+      unlink(node);
+      link_before(position.node_, object);
+    }
+  }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for (IntrusiveListHook* node = head_.next; node != &head_;
+         node = node->next) {
+      func(*to_object(node));
+    }
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for (const IntrusiveListHook* node = head_.next; node != &head_;
+         node = node->next) {
+      func(*to_object(node));
+    }
+  }
+
+protected:
+  template <typename Reference, typename Pointer>
+  class Iterator {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Tp value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Pointer pointer;
+    typedef Reference reference;
+
+    Iterator() : node_(nullptr) {}
+    // Allows iterator to const_iterator conversion, but not the reverse.
+    template <typename OtherReference, typename OtherPointer,
+              typename = typename std::enable_if<
+                std::is_convertible<OtherPointer, Pointer>::value>::type>
+    Iterator(const Iterator<OtherReference, OtherPointer>& other) :
+      node_(other.node_) {}
+
+    reference operator*() const { return *to_object(node_); }
+    pointer operator->() const { return to_object(node_); }
+    Iterator& operator++() {
+      node_ = node_->next;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      node_ = node_->next;
+      return old;
+    }
+    Iterator& operator--() {
+      node_ = node_->prev;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator old = *this;
+      node_ = node_->prev;
+      return old;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator==(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ == rhs.node_;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator!=(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ != rhs.node_;
+    }
+
+  private:
+    friend class IntrusiveList;
+    template <typename, typename> friend class Iterator;
+    explicit Iterator(const IntrusiveListHook* node) :
+      node_(const_cast<IntrusiveListHook*>(node)) {}
+    IntrusiveListHook* node_;
+  };
+
+  // Offset of the hook inside Tp, measured on raw storage so that no Tp
+  // is constructed; the compiler folds it to a constant.
+  static std::ptrdiff_t hook_offset() {
+    typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type storage;
+    const Tp* object = reinterpret_cast<const Tp*>(&storage);
+    return reinterpret_cast<const char*>(&(object->*hook)) -
+           reinterpret_cast<const char*>(object);
+  }
+  static Tp* to_object(const IntrusiveListHook* node) {
+    return reinterpret_cast<Tp*>(
+      const_cast<char*>(reinterpret_cast<const char*>(node)) - hook_offset());
+  }
+
+  void reset() {
+    head_.prev = &head_;
+    head_.next = &head_;
+  }
+  // Adopts the chain [first, last] of size elements; the chain is ignored
+  // when size is 0.
+  void take(IntrusiveListHook* first, IntrusiveListHook* last,
+            size_type size) {
+    if (size == 0) {
+      reset();
+    } else {
+      head_.next = first;
+      head_.prev = last;
+      first->prev = &head_;
+      last->next = &head_;
+    }
+    size_ = size;
+  }
+  void link_before(IntrusiveListHook* position, reference object) {
+    IntrusiveListHook* node = &(object.*hook);
+    node->prev = position->prev;
+    node->next = position;
+    position->prev->next = node;
+    position->prev = node;
+    ++size_;
+  }
+  void unlink(IntrusiveListHook* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+    --size_;
+  }
+
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the list is empty.");
+    }
+  }
+
+  size_type size_;
+  IntrusiveListHook head_;
+};
+
+#endif  // INTRUSIVE_LIST_H_
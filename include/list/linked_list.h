@@ -22,67 +22,129 @@
 #ifndef LIST_H_
 #define LIST_H_
 
+#include <cstddef>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 
-template <typename Tp>
+#include "memory/node_pool.h"
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
 class List {
+protected:
+  struct Link;
+  struct Node;
+  template <typename Reference, typename Pointer>
+  class Iterator;
+
 public:
   typedef Tp value_type;
   typedef Tp& reference;
   typedef const Tp& const_reference;
   typedef std::size_t size_type;
+  typedef Iterator<Tp&, Tp*> iterator;
+  typedef Iterator<const Tp&, const Tp*> const_iterator;
+  typedef Alloc allocator_type;
 
-  List() : size_(0), head_ptr_(nullptr) {}
-  List(const List& other) : size_(other.size_), head_ptr_(nullptr) {
+  List() : size_(0), tail_ptr_(nullptr) {}
+  explicit List(const Alloc& alloc) :
+    size_(0), tail_ptr_(nullptr), pool_(NodeAllocator(alloc)) {}
+  List(const List& other) :
+    size_(other.size_), tail_ptr_(nullptr),
+    pool_(std::allocator_traits<NodeAllocator>::
+          select_on_container_copy_construction(other.pool_.get_allocator())) {
     if (!other.empty()) {
-      deep_copy(head_ptr_, other);
+      deep_copy(head_.next, tail_ptr_, other);
     }
   }
-  List(List&& other) : 
-    size_(std::move(other.size_)), head_ptr_(std::move(other.head_ptr_)) {}
-  List(const std::initializer_list<value_type>& il) : 
-    size_(0), head_ptr_(nullptr) {
-    size_type index = 0;
+  List(const List& other, const Alloc& alloc) :
+    size_(other.size_), tail_ptr_(nullptr),
+    pool_(NodeAllocator(alloc)) {
+    if (!other.empty()) {
+      deep_copy(head_.next, tail_ptr_, other);
+    }
+  }
+  List(List&& other) : size_(0), tail_ptr_(nullptr) {
+    swap(other);
+  }
+  List(const std::initializer_list<value_type>& il,
+       const Alloc& alloc = Alloc()) :
+    size_(0), tail_ptr_(nullptr), pool_(NodeAllocator(alloc)) {
     for (const value_type& element : il) {
-      insert(index, element);
-      ++index;
+      emplace_back(element);
     }
   }
+  // Copy assignment keeps this list's allocator; move assignment and swap
+  // exchange allocators along with the nodes.
   List& operator=(const List& rhs) {
-    size_type new_size = rhs.size_;
-    NodePtr new_head_ptr = nullptr;
-    if (!rhs.empty()) {
-      deep_copy(new_head_ptr, rhs);
-    }
-    clear();
-    size_ = new_size;
-    head_ptr_ = new_head_ptr;
+    List copy(rhs, get_allocator());
+    swap(copy);
     return *this;
   }
   List& operator=(List&& rhs) {
-    size_ = std::move(rhs.size_);
-    head_ptr_ = std::move(rhs.head_ptr_);
+    swap(rhs);
     return *this;
   }
   List& operator=(const std::initializer_list<value_type>& il) {
     clear();
-    size_type index = 0;
     for (const value_type& element : il) {
-      insert(index, element);
-      ++index;
+      emplace_back(element);
     }
     return *this;
   }
-  virtual ~List() {}
+  virtual ~List() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const {
+    return allocator_type(pool_.get_allocator());
+  }
   void clear() {
+    pool_.destroy_all(head_.next, &Node::next);
     size_ = 0;
-    head_ptr_ = nullptr;
+    head_.next = nullptr;
+    tail_ptr_ = nullptr;
+  }
+  void swap(List& other) {
+    std::swap(size_, other.size_);
+    std::swap(head_.next, other.head_.next);
+    std::swap(tail_ptr_, other.tail_ptr_);
+    pool_.swap(other.pool_);
+  }
+
+  // The position before the first element, for inserting or erasing at
+  // the front with emplace_after and erase_after. It is never dereferenced.
+  iterator before_begin() { return iterator(&head_); }
+  const_iterator before_begin() const {
+    return const_iterator(const_cast<Link*>(&head_));
+  }
+  const_iterator cbefore_begin() const { return before_begin(); }
+  iterator begin() { return iterator(head_.next); }
+  const_iterator begin() const { return const_iterator(head_.next); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(nullptr); }
+  const_iterator end() const { return const_iterator(nullptr); }
+  const_iterator cend() const { return end(); }
+
+  reference front() {
+    require_nonempty("List::front()");
+    return head_.next->value;
+  }
+  const_reference front() const {
+    require_nonempty("List::front()");
+    return head_.next->value;
+  }
+  reference back() {
+    require_nonempty("List::back()");
+    return tail_ptr_->value;
+  }
+  const_reference back() const {
+    require_nonempty("List::back()");
+    return tail_ptr_->value;
   }
 
   const_reference retrieve(const size_type& index) const {
@@ -98,61 +160,197 @@ public:
   value_type remove(const size_type& index) {
     require_nonempty("List::remove()");
     check_range_inclusive_exclusive(index);
-    value_type removed_value = value_type();
+    NodePtr removed_ptr = nullptr;
     if (index == 0) {
-      removed_value = head_ptr_->value;
-      head_ptr_ = head_ptr_->next;
+      removed_ptr = head_.next;
+      head_.next = removed_ptr->next;
+      if (head_.next == nullptr) {
+        tail_ptr_ = nullptr;
+      }
     } else {
       NodePtr prev_ptr = to_node_ptr(index - 1);
-      removed_value = prev_ptr->next->value;
-      prev_ptr->next = prev_ptr->next->next;
+      removed_ptr = prev_ptr->next;
+      prev_ptr->next = removed_ptr->next;
+      if (prev_ptr->next == nullptr) {
+        tail_ptr_ = prev_ptr;
+      }
     }
     --size_;
+    value_type removed_value = std::move(removed_ptr->value);
+    pool_.destroy(removed_ptr);
     return removed_value;
   }
   void insert(const size_type& index, const value_type& value) {
     check_range_inclusive_inclusive(index);
-    NodePtr new_ptr = std::make_shared<Node>(value);
     if (index == 0) {
-      new_ptr->next = head_ptr_;
-      head_ptr_ = new_ptr;
+      emplace_front(value);
+    } else if (index == size_) {
+      emplace_back(value);
     } else {
-      NodePtr prev_ptr = to_node_ptr(index - 1);
-      new_ptr->next = prev_ptr->next;
-      prev_ptr->next = new_ptr;
+      link_after(to_node_ptr(index - 1), pool_.create(value));
     }
-    ++size_;
   }
-  void traverse(void (*f)(value_type&)) {
-    NodePtr traverse_ptr = head_ptr_;
-    while (traverse_ptr != nullptr) {
-      (*f)(traverse_ptr->value);
-      traverse_ptr = traverse_ptr->next;
+
+  // O(1) edits through iterators. A singly linked node cannot unlink
+  // itself, so removal goes through the predecessor with erase_after().
+  template <typename... Args>
+  reference emplace_front(Args&&... args) {
+    NodePtr new_ptr = pool_.create(std::forward<Args>(args)...);
+    link_after(&head_, new_ptr);
+    return new_ptr->value;
+  }
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    NodePtr new_ptr = pool_.create(std::forward<Args>(args)...);
+    link_after(tail_ptr_ == nullptr ? &head_ : tail_ptr_, new_ptr);
+    return new_ptr->value;
+  }
+  void push_front(const value_type& value) { emplace_front(value); }
+  void push_front(value_type&& value) { emplace_front(std::move(value)); }
+  void push_back(const value_type& value) { emplace_back(value); }
+  void push_back(value_type&& value) { emplace_back(std::move(value)); }
+  void pop_front() {
+    require_nonempty("List::pop_front()");
+    NodePtr old_head_ptr = head_.next;
+    head_.next = old_head_ptr->next;
+    pool_.destroy(old_head_ptr);
+    if (head_.next == nullptr) {
+      tail_ptr_ = nullptr;
+    }
+    --size_;
+  }
+  template <typename... Args>
+  iterator emplace_after(const_iterator position, Args&&... args) {
+    if (position.node_ == nullptr) {
+      throw std::out_of_range(
+        "List::emplace_after() is undefined at the end position.");
+    }
+    NodePtr new_ptr = pool_.create(std::forward<Args>(args)...);
+    link_after(position.node_, new_ptr);
+    return iterator(new_ptr);
+  }
+  iterator insert_after(const_iterator position, const value_type& value) {
+    return emplace_after(position, value);
+  }
+  iterator insert_after(const_iterator position, value_type&& value) {
+    return emplace_after(position, std::move(value));
+  }
+  // Removes the element following position and returns the iterator to
+  // the element after the removed one.
+  iterator erase_after(const_iterator position) {
+    Link* prev_node = position.node_;
+    if (prev_node == nullptr || prev_node->next == nullptr) {
+      throw std::out_of_range(
+        "List::erase_after() has no element after the position.");
+    }
+    NodePtr removed_ptr = prev_node->next;
+    prev_node->next = removed_ptr->next;
+    pool_.destroy(removed_ptr);
+    if (prev_node->next == nullptr) {
+      tail_ptr_ = prev_node == &head_ ? nullptr :
+                                        static_cast<Node*>(prev_node);
+    }
+    --size_;
+    return iterator(prev_node->next);
+  }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for (Node* node = head_.next; node != nullptr;
+         node = node->next) {
+      func(node->value);
+    }
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for (const Node* node = head_.next; node != nullptr;
+         node = node->next) {
+      func(node->value);
     }
   }
 
 protected:
-  struct Node;
-  typedef std::shared_ptr<Node> NodePtr;
-  struct Node {
-    Node() : value(value_type()), next(nullptr) {}
-    explicit Node(const value_type& x) : value(x), next(nullptr) {}
-    explicit Node(value_type&& x) : value(std::move(x)), next(nullptr) {}
-    Tp value;
+  typedef Node* NodePtr;
+  // The list keeps a Link of its own ahead of the first node, which
+  // before_begin() points at.
+  struct Link {
+    Link() : next(nullptr) {}
     NodePtr next;
   };
+  struct Node : Link {
+    Node() : value(value_type()) {}
+    template <typename... Args>
+    explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+    Tp value;
+  };
+  typedef typename std::allocator_traits<Alloc>::template
+    rebind_alloc<Node> NodeAllocator;
 
-  void deep_copy(NodePtr& new_head_ptr, const List& other) {
-    new_head_ptr = std::make_shared<Node>(other.head_ptr_->value);
-    NodePtr copy_ptr = new_head_ptr, other_ptr = other.head_ptr_;
+  template <typename Reference, typename Pointer>
+  class Iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Tp value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Pointer pointer;
+    typedef Reference reference;
+
+    Iterator() : node_(nullptr) {}
+    // Allows iterator to const_iterator conversion, but not the reverse.
+    template <typename OtherReference, typename OtherPointer,
+              typename = typename std::enable_if<
+                std::is_convertible<OtherPointer, Pointer>::value>::type>
+    Iterator(const Iterator<OtherReference, OtherPointer>& other) :
+      node_(other.node_) {}
+
+    reference operator*() const { return static_cast<Node*>(node_)->value; }
+    pointer operator->() const { return &static_cast<Node*>(node_)->value; }
+    Iterator& operator++() {
+      node_ = node_->next;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      node_ = node_->next;
+      return old;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator==(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ == rhs.node_;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator!=(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ != rhs.node_;
+    }
+
+  private:
+    friend class List;
+    template <typename, typename> friend class Iterator;
+    explicit Iterator(Link* node) : node_(node) {}
+    Link* node_;
+  };
+
+  void deep_copy(NodePtr& new_head_ptr, Node*& new_tail_ptr,
+                 const List& other) {
+    new_head_ptr = pool_.create(other.head_.next->value);
+    NodePtr copy_ptr = new_head_ptr, other_ptr = other.head_.next;
     while (other_ptr->next != nullptr) {
       other_ptr = other_ptr->next;
-      copy_ptr->next = std::make_shared<Node>(other_ptr->value);
+      copy_ptr->next = pool_.create(other_ptr->value);
       copy_ptr = copy_ptr->next;
     }
+    new_tail_ptr = copy_ptr;
+  }
+  void link_after(Link* prev_node, NodePtr new_ptr) {
+    new_ptr->next = prev_node->next;
+    prev_node->next = new_ptr;
+    if (new_ptr->next == nullptr) {
+      tail_ptr_ = new_ptr;
+    }
+    ++size_;
   }
   NodePtr to_node_ptr(const size_type& index) const {
-    NodePtr iter_ptr = head_ptr_;
+    NodePtr iter_ptr = head_.next;
     for (size_type i = 0; i < index; ++i) {
       iter_ptr = iter_ptr->next;
     }
@@ -167,22 +365,24 @@ protected:
   void check_range_inclusive_exclusive(const size_type& index) const {
     if (!(index >= 0 && index <= size_ - 1)) {
       throw std::out_of_range(
-        "List range check failed: " + 
+        "List range check failed: " +
         std::to_string(index) + " is out of the range [0, " +
         std::to_string(size_) + ").");
     }
-  }  
+  }
   void check_range_inclusive_inclusive(const size_type& index) const {
     if (!(index >= 0 && index <= size_)) {
       throw std::out_of_range(
-        "List range check failed: " + 
+        "List range check failed: " +
         std::to_string(index) + " is out of the range [0, " +
         std::to_string(size_) + "].");
     }
-  }  
+  }
 
   size_type size_;
-  NodePtr head_ptr_;
+  Link head_;
+  NodePtr tail_ptr_;
+  NodePool<Node, NodeAllocator> pool_;
 };
 
-#endif  // LIST_H_
\ No newline at end of file
+#endif  // LIST_H_
@@ -0,0 +1,510 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef ROPE_H_
+#define ROPE_H_
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Persistent sequence kept as a height-balanced (AVL) tree whose leaves
+ * hold contiguous chunks of up to leaf_capacity elements. Index, insert,
+ * remove, split and concat all copy O(log n) nodes; a split or concat
+ * also copies a chunk at each seam it folds, O(log n) chunks at worst.
+ *
+ * Nodes are immutable and shared between ropes: copying a rope is O(1),
+ * and an update copies only the path from the root to the leaf it
+ * touches, so every copy is a snapshot that later updates never change.
+ * Snapshots may be read from several threads at once.
+ *
+ * Concatenation folds a small chunk into its neighbour at the seam, so
+ * building a rope by repeated push_back still yields full leaves.
+ */
+template <typename Tp, std::size_t leaf_capacity =
+          (sizeof(Tp) < 64 ? 256 / sizeof(Tp) : 4)>
+class Rope {
+  static_assert(leaf_capacity >= 2, "leaf_capacity must be at least 2.");
+
+protected:
+  struct Node;
+  typedef std::shared_ptr<const Node> NodePtr;
+
+public:
+  typedef Tp value_type;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+
+  // A run of elements stored contiguously in one leaf.
+  struct Chunk {
+    const Tp* begin() const { return data; }
+    const Tp* end() const { return data + size; }
+    const Tp* data;
+    size_type size;
+  };
+  class ChunkIterator;
+  typedef ChunkIterator chunk_iterator;
+
+  Rope() {}
+  Rope(const std::initializer_list<value_type>& il) :
+    root_(build(il.begin(), il.end())) {}
+  template <typename InputIterator>
+  Rope(InputIterator first, InputIterator last) :
+    root_(build(first, last)) {}
+  Rope(const Rope& other) = default;
+  Rope(Rope&& other) : root_(std::move(other.root_)) {}
+  Rope& operator=(const Rope& rhs) = default;
+  Rope& operator=(Rope&& rhs) {
+    root_ = std::move(rhs.root_);
+    return *this;
+  }
+  virtual ~Rope() {}
+
+  bool empty() const { return root_ == nullptr; }
+  size_type size() const { return size_of(root_); }
+  void clear() { root_.reset(); }
+  void swap(Rope& other) { root_.swap(other.root_); }
+
+  const_reference operator[](size_type index) const {
+    const Node* node = root_.get();
+    while (!node->is_leaf()) {
+      size_type left_size = node->left->size;
+      if (index < left_size) {
+        node = node->left.get();
+      } else {
+        index -= left_size;
+        node = node->right.get();
+      }
+    }
+    return node->chunk[index];
+  }
+  const_reference retrieve(const size_type& index) const {
+    require_nonempty("Rope::retrieve()");
+    check_range_inclusive_exclusive(index);
+    return (*this)[index];
+  }
+  void replace(const size_type& index, const value_type& value) {
+    require_nonempty("Rope::replace()");
+    check_range_inclusive_exclusive(index);
+    root_ = replace_at(root_, index, value);
+  }
+  void insert(const size_type& index, const value_type& value) {
+    check_range_inclusive_inclusive(index);
+    root_ = insert_at(root_, index, value);
+  }
+  void insert(const size_type& index, const Rope& rope) {
+    check_range_inclusive_inclusive(index);
+    std::pair<NodePtr, NodePtr> halves = split_at(root_, index);
+    root_ = join(join(halves.first, rope.root_), halves.second);
+  }
+  value_type remove(const size_type& index) {
+    require_nonempty("Rope::remove()");
+    check_range_inclusive_exclusive(index);
+    value_type removed_value = (*this)[index];
+    root_ = remove_at(root_, index);
+    return removed_value;
+  }
+  // Removes the elements [index, index + count).
+  void erase(const size_type& index, const size_type& count) {
+    check_range_inclusive_inclusive(index);
+    check_range_inclusive_inclusive(index + count);
+    std::pair<NodePtr, NodePtr> front = split_at(root_, index);
+    std::pair<NodePtr, NodePtr> back = split_at(front.second, count);
+    root_ = join(front.first, back.second);
+  }
+  void push_back(const value_type& value) {
+    root_ = join(root_, make_leaf(std::vector<Tp>(1, value)));
+  }
+  void push_front(const value_type& value) {
+    root_ = join(make_leaf(std::vector<Tp>(1, value)), root_);
+  }
+  void append(const Rope& rope) { root_ = join(root_, rope.root_); }
+
+  static Rope concat(const Rope& lhs, const Rope& rhs) {
+    return Rope(join(lhs.root_, rhs.root_));
+  }
+  // Returns the elements [0, index) and [index, size()).
+  std::pair<Rope, Rope> split(const size_type& index) const {
+    check_range_inclusive_inclusive(index);
+    std::pair<NodePtr, NodePtr> halves = split_at(root_, index);
+    return std::make_pair(Rope(std::move(halves.first)),
+                          Rope(std::move(halves.second)));
+  }
+  // The elements [index, index + count).
+  Rope substr(const size_type& index, const size_type& count) const {
+    check_range_inclusive_inclusive(index);
+    check_range_inclusive_inclusive(index + count);
+    NodePtr back = split_at(root_, index).second;
+    return Rope(split_at(back, count).first);
+  }
+
+  chunk_iterator chunk_begin() const { return chunk_iterator(root_.get()); }
+  chunk_iterator chunk_end() const { return chunk_iterator(); }
+
+  template <typename Function>
+  void traverse(Function func) const {
+    for (chunk_iterator it = chunk_begin(); it != chunk_end(); ++it) {
+      for (const value_type& element : *it) {
+        func(element);
+      }
+    }
+  }
+
+  // Visits the leaves in order. Pointers stay valid while any rope that
+  // shares the leaf is alive.
+  class ChunkIterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Chunk value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Chunk* pointer;
+    typedef const Chunk& reference;
+
+    ChunkIterator() : leaf_(nullptr) {
+      chunk_.data = nullptr;
+      chunk_.size = 0;
+    }
+
+    reference operator*() const { return chunk_; }
+    pointer operator->() const { return &chunk_; }
+    ChunkIterator& operator++() {
+      if (pending_.empty()) {
+        leaf_ = nullptr;
+        chunk_.data = nullptr;
+        chunk_.size = 0;
+      } else {
+        const Node* node = pending_.back();
+        pending_.pop_back();
+        descend(node);
+      }
+      return *this;
+    }
+    ChunkIterator operator++(int) {
+      ChunkIterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const ChunkIterator& rhs) const {
+      return leaf_ == rhs.leaf_;
+    }
+    bool operator!=(const ChunkIterator& rhs) const {
+      return leaf_ != rhs.leaf_;
+    }
+
+  private:
+    friend class Rope;
+    explicit ChunkIterator(const Node* root) : leaf_(nullptr) {
+      chunk_.data = nullptr;
+      chunk_.size = 0;
+      if (root != nullptr) {
+        // The stack never holds more than one node per level.
+        pending_.reserve(root->height);
+        descend(root);
+      }
+    }
+    void descend(const Node* node) {
+      while (!node->is_leaf()) {
+        pending_.push_back(node->right.get());
+        node = node->left.get();
+      }
+      leaf_ = node;
+      chunk_.data = node->chunk.data();
+      chunk_.size = node->chunk.size();
+    }
+
+    const Node* leaf_;
+    Chunk chunk_;
+    // Right subtrees still to be visited, innermost last.
+    std::vector<const Node*> pending_;
+  };
+
+protected:
+  // A leaf has height 0 and a nonempty chunk; an internal node has two
+  // children and an empty chunk. The sizes of the outermost leaves are
+  // kept so that join() can tell in O(1) whether a seam folds.
+  struct Node {
+    explicit Node(std::vector<Tp>&& c) :
+      chunk(std::move(c)), size(chunk.size()), height(0),
+      first_leaf_size(size), last_leaf_size(size) {}
+    Node(const NodePtr& l, const NodePtr& r) :
+      left(l), right(r), size(l->size + r->size),
+      height(1 + (l->height > r->height ? l->height : r->height)),
+      first_leaf_size(l->first_leaf_size),
+      last_leaf_size(r->last_leaf_size) {}
+    bool is_leaf() const { return height == 0; }
+    std::vector<Tp> chunk;
+    NodePtr left;
+    NodePtr right;
+    size_type size;
+    size_type height;
+    size_type first_leaf_size;
+    size_type last_leaf_size;
+  };
+
+  explicit Rope(NodePtr root) : root_(std::move(root)) {}
+
+  static size_type size_of(const NodePtr& node) {
+    return node == nullptr ? 0 : node->size;
+  }
+  static size_type height_of(const NodePtr& node) { return node->height; }
+  static NodePtr make_leaf(std::vector<Tp>&& chunk) {
+    return std::make_shared<const Node>(std::move(chunk));
+  }
+  static NodePtr make_node(const NodePtr& left, const NodePtr& right) {
+    return std::make_shared<const Node>(left, right);
+  }
+
+  template <typename InputIterator>
+  static NodePtr build(InputIterator first, InputIterator last) {
+    std::vector<NodePtr> leaves;
+    std::vector<Tp> chunk;
+    for (; first != last; ++first) {
+      chunk.push_back(*first);
+      if (chunk.size() == leaf_capacity) {
+        leaves.push_back(make_leaf(std::move(chunk)));
+        chunk = std::vector<Tp>();
+      }
+    }
+    if (!chunk.empty()) {
+      leaves.push_back(make_leaf(std::move(chunk)));
+    }
+    return leaves.empty() ? NodePtr() : build(leaves, 0, leaves.size());
+  }
+  // Halving the leaf range keeps sibling heights within one of each other.
+  static NodePtr build(const std::vector<NodePtr>& leaves, size_type first,
+                       size_type last) {
+    if (last - first == 1) {
+      return leaves[first];
+    }
+    size_type middle = first + (last - first) / 2;
+    return make_node(build(leaves, first, middle),
+                     build(leaves, middle, last));
+  }
+
+  // Joins two subtrees whose heights differ by at most two, rotating once
+  // or twice to restore the AVL invariant.
+  static NodePtr balance(const NodePtr& left, const NodePtr& right) {
+    size_type left_height = height_of(left);
+    size_type right_height = height_of(right);
+    if (left_height > right_height + 1) {
+      const NodePtr& outer = left->left;
+      const NodePtr& inner = left->right;
+      if (height_of(outer) >= height_of(inner)) {
+        return make_node(outer, make_node(inner, right));
+      }
+      return make_node(make_node(outer, inner->left),
+                       make_node(inner->right, right));
+    }
+    if (right_height > left_height + 1) {
+      const NodePtr& inner = right->left;
+      const NodePtr& outer = right->right;
+      if (height_of(outer) >= height_of(inner)) {
+        return make_node(make_node(left, inner), outer);
+      }
+      return make_node(make_node(left, inner->left),
+                       make_node(inner->right, outer));
+    }
+    return make_node(left, right);
+  }
+  // Like balance(), but merges two leaves that fit into one.
+  static NodePtr rebuild(const NodePtr& left, const NodePtr& right) {
+    if (left->is_leaf() && right->is_leaf() &&
+        left->size + right->size <= leaf_capacity) {
+      std::vector<Tp> chunk(left->chunk);
+      chunk.insert(chunk.end(), right->chunk.begin(), right->chunk.end());
+      return make_leaf(std::move(chunk));
+    }
+    return balance(left, right);
+  }
+
+  // Concatenates two trees in O(|height(left) - height(right)| + 1) node
+  // copies, plus one chunk copy if the seam folds.
+  static NodePtr join(const NodePtr& left, const NodePtr& right) {
+    if (left == nullptr) {
+      return right;
+    }
+    if (right == nullptr) {
+      return left;
+    }
+    if (right->is_leaf() && left->last_leaf_size + right->size <=
+                            leaf_capacity) {
+      return append_chunk(left, right->chunk);
+    }
+    if (left->is_leaf() && right->first_leaf_size + left->size <=
+                           leaf_capacity) {
+      return prepend_chunk(right, left->chunk);
+    }
+    if (height_of(left) > height_of(right) + 1) {
+      return balance(left->left, join(left->right, right));
+    }
+    if (height_of(right) > height_of(left) + 1) {
+      return balance(join(left, right->left), right->right);
+    }
+    return make_node(left, right);
+  }
+  // Shapes and heights are unchanged; only the spine is copied.
+  static NodePtr append_chunk(const NodePtr& node,
+                              const std::vector<Tp>& chunk) {
+    if (node->is_leaf()) {
+      std::vector<Tp> merged(node->chunk);
+      merged.insert(merged.end(), chunk.begin(), chunk.end());
+      return make_leaf(std::move(merged));
+    }
+    return make_node(node->left, append_chunk(node->right, chunk));
+  }
+  static NodePtr prepend_chunk(const NodePtr& node,
+                               const std::vector<Tp>& chunk) {
+    if (node->is_leaf()) {
+      std::vector<Tp> merged(chunk);
+      merged.insert(merged.end(), node->chunk.begin(), node->chunk.end());
+      return make_leaf(std::move(merged));
+    }
+    return make_node(prepend_chunk(node->left, chunk), node->right);
+  }
+
+  // Splits into the elements before index and the rest. The height
+  // differences of the joins along the way telescope, so the whole split
+  // copies O(log n) nodes, plus at most one chunk per join.
+  static std::pair<NodePtr, NodePtr> split_at(const NodePtr& node,
+                                              size_type index) {
+    if (index == 0) {
+      return std::make_pair(NodePtr(), node);
+    }
+    if (index == size_of(node)) {
+      return std::make_pair(node, NodePtr());
+    }
+    if (node->is_leaf()) {
+      typename std::vector<Tp>::const_iterator middle =
+        node->chunk.begin() + index;
+      return std::make_pair(
+        make_leaf(std::vector<Tp>(node->chunk.begin(), middle)),
+        make_leaf(std::vector<Tp>(middle, node->chunk.end())));
+    }
+    size_type left_size = node->left->size;
+    if (index <= left_size) {
+      std::pair<NodePtr, NodePtr> halves = split_at(node->left, index);
+      return std::make_pair(halves.first, join(halves.second, node->right));
+    }
+    std::pair<NodePtr, NodePtr> halves =
+      split_at(node->right, index - left_size);
+    return std::make_pair(join(node->left, halves.first), halves.second);
+  }
+
+  static NodePtr replace_at(const NodePtr& node, size_type index,
+                            const value_type& value) {
+    if (node->is_leaf()) {
+      std::vector<Tp> chunk(node->chunk);
+      chunk[index] = value;
+      return make_leaf(std::move(chunk));
+    }
+    size_type left_size = node->left->size;
+    if (index < left_size) {
+      return make_node(replace_at(node->left, index, value), node->right);
+    }
+    return make_node(node->left,
+                     replace_at(node->right, index - left_size, value));
+  }
+  // A full leaf is split in half, which may grow the subtree by one level.
+  static NodePtr insert_at(const NodePtr& node, size_type index,
+                           const value_type& value) {
+    if (node == nullptr) {
+      return make_leaf(std::vector<Tp>(1, value));
+    }
+    if (node->is_leaf()) {
+      std::vector<Tp> chunk;
+      chunk.reserve(node->size + 1);
+      chunk.insert(chunk.end(), node->chunk.begin(),
+                   node->chunk.begin() + index);
+      chunk.push_back(value);
+      chunk.insert(chunk.end(), node->chunk.begin() + index,
+                   node->chunk.end());
+      if (chunk.size() <= leaf_capacity) {
+        return make_leaf(std::move(chunk));
+      }
+      typename std::vector<Tp>::iterator middle =
+        chunk.begin() + chunk.size() / 2;
+      return make_node(make_leaf(std::vector<Tp>(chunk.begin(), middle)),
+                       make_leaf(std::vector<Tp>(middle, chunk.end())));
+    }
+    size_type left_size = node->left->size;
+    if (index <= left_size) {
+      return balance(insert_at(node->left, index, value), node->right);
+    }
+    return balance(node->left,
+                   insert_at(node->right, index - left_size, value));
+  }
+  // An emptied leaf disappears; a leaf that fits into its sibling leaf is
+  // merged with it.
+  static NodePtr remove_at(const NodePtr& node, size_type index) {
+    if (node->is_leaf()) {
+      if (node->size == 1) {
+        return NodePtr();
+      }
+      std::vector<Tp> chunk;
+      chunk.reserve(node->size - 1);
+      chunk.insert(chunk.end(), node->chunk.begin(),
+                   node->chunk.begin() + index);
+      chunk.insert(chunk.end(), node->chunk.begin() + index + 1,
+                   node->chunk.end());
+      return make_leaf(std::move(chunk));
+    }
+    size_type left_size = node->left->size;
+    if (index < left_size) {
+      NodePtr left = remove_at(node->left, index);
+      return left == nullptr ? node->right : rebuild(left, node->right);
+    }
+    NodePtr right = remove_at(node->right, index - left_size);
+    return right == nullptr ? node->left : rebuild(node->left, right);
+  }
+
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the rope is empty.");
+    }
+  }
+  void check_range_inclusive_exclusive(const size_type& index) const {
+    if (index >= size()) {
+      throw std::out_of_range(
+        "Rope range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size()) + ").");
+    }
+  }
+  void check_range_inclusive_inclusive(const size_type& index) const {
+    if (index > size()) {
+      throw std::out_of_range(
+        "Rope range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size()) + "].");
+    }
+  }
+
+  NodePtr root_;
+};
+
+#endif  // ROPE_H_
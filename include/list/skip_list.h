@@ -0,0 +1,382 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef SKIP_LIST_H_
+#define SKIP_LIST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/*
+ * Ordered set kept as a skip list. Every link records how many elements it
+ * skips, so besides O(log n) expected find/insert/remove the list answers
+ * positional queries: retrieve(index) returns the index-th smallest
+ * element and rank(value) counts the elements less than value.
+ *
+ * Tower heights are drawn with p = 1/4 from a generator local to the list,
+ * so two lists built from the same sequence have the same shape.
+ */
+template <typename Tp, typename Compare = std::less<Tp>>
+class SkipList {
+protected:
+  struct Node;
+  template <typename Reference, typename Pointer>
+  class Iterator;
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+  typedef Compare value_compare;
+  // Elements are keys, so only const access is handed out.
+  typedef Iterator<const Tp&, const Tp*> iterator;
+  typedef Iterator<const Tp&, const Tp*> const_iterator;
+
+  explicit SkipList(const Compare& compare = Compare()) :
+    size_(0), level_(1), seed_(default_seed), compare_(compare) {
+    reset_head();
+  }
+  SkipList(const SkipList& other) :
+    size_(0), level_(1), seed_(other.seed_), compare_(other.compare_) {
+    reset_head();
+    Link* update[max_level];
+    for (size_type i = 0; i < max_level; ++i) {
+      update[i] = &head_[i];
+    }
+    // Copies keep the towers of the original, so positions stay valid.
+    for (const Node* node = other.head_[0].next; node != nullptr;
+         node = node->links()[0].next) {
+      Node* copy = create_node(node->height, node->value);
+      for (size_type i = 0; i < node->height; ++i) {
+        copy->links()[i].width = node->links()[i].width;
+        update[i]->next = copy;
+        update[i] = &copy->links()[i];
+      }
+    }
+    for (size_type i = 0; i < max_level; ++i) {
+      head_[i].width = other.head_[i].width;
+    }
+    size_ = other.size_;
+    level_ = other.level_;
+  }
+  SkipList(SkipList&& other) :
+    size_(0), level_(1), seed_(default_seed), compare_(other.compare_) {
+    reset_head();
+    swap(other);
+  }
+  SkipList& operator=(const SkipList& rhs) {
+    SkipList copy(rhs);
+    swap(copy);
+    return *this;
+  }
+  SkipList& operator=(SkipList&& rhs) {
+    swap(rhs);
+    return *this;
+  }
+  virtual ~SkipList() { clear(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  void clear() {
+    Node* node = head_[0].next;
+    while (node != nullptr) {
+      Node* next = node->links()[0].next;
+      destroy_node(node);
+      node = next;
+    }
+    size_ = 0;
+    level_ = 1;
+    reset_head();
+  }
+  void swap(SkipList& other) {
+    std::swap(size_, other.size_);
+    std::swap(level_, other.level_);
+    std::swap(seed_, other.seed_);
+    std::swap(compare_, other.compare_);
+    for (size_type i = 0; i < max_level; ++i) {
+      std::swap(head_[i], other.head_[i]);
+    }
+  }
+
+  iterator begin() const { return iterator(head_[0].next); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() const { return iterator(nullptr); }
+  const_iterator cend() const { return end(); }
+
+  bool find(const value_type& value) const {
+    const Node* node = lower_bound_node(value);
+    return node != nullptr && !compare_(value, node->value);
+  }
+  // Returns false if an equivalent element is already present.
+  bool insert(const value_type& value) {
+    Link* update[max_level];
+    size_type position[max_level];
+    const Node* node = search(value, update, position);
+    if (node != nullptr && !compare_(value, node->value)) {
+      return false;
+    }
+    size_type height = random_height();
+    if (height > level_) {
+      level_ = height;
+    }
+    Node* new_node = create_node(height, value);
+    // Positions count the head as 0, so the new element lands at
+    // position[0] + 1 and everything after it moves up by one.
+    size_type new_position = position[0] + 1;
+    for (size_type i = 0; i < height; ++i) {
+      Link& link = new_node->links()[i];
+      link.next = update[i]->next;
+      link.width = position[i] + update[i]->width + 1 - new_position;
+      update[i]->next = new_node;
+      update[i]->width = new_position - position[i];
+    }
+    for (size_type i = height; i < max_level; ++i) {
+      ++update[i]->width;
+    }
+    ++size_;
+    return true;
+  }
+  // Returns false if no equivalent element was present.
+  bool remove(const value_type& value) {
+    Link* update[max_level];
+    size_type position[max_level];
+    Node* node = search(value, update, position);
+    if (node == nullptr || compare_(value, node->value)) {
+      return false;
+    }
+    for (size_type i = 0; i < node->height; ++i) {
+      update[i]->next = node->links()[i].next;
+      update[i]->width += node->links()[i].width - 1;
+    }
+    for (size_type i = node->height; i < max_level; ++i) {
+      --update[i]->width;
+    }
+    destroy_node(node);
+    --size_;
+    while (level_ > 1 && head_[level_ - 1].next == nullptr) {
+      --level_;
+    }
+    return true;
+  }
+
+  // The index-th smallest element.
+  const_reference retrieve(const size_type& index) const {
+    require_nonempty("SkipList::retrieve()");
+    check_range_inclusive_exclusive(index);
+    size_type target = index + 1, position = 0;
+    const Link* links = head_;
+    const Node* node = nullptr;
+    for (size_type i = level_; i-- > 0;) {
+      while (links[i].next != nullptr &&
+             position + links[i].width <= target) {
+        position += links[i].width;
+        node = links[i].next;
+        links = node->links();
+      }
+    }
+    return node->value;
+  }
+  // Number of elements less than value.
+  size_type rank(const value_type& value) const {
+    size_type position = 0;
+    const Link* links = head_;
+    for (size_type i = level_; i-- > 0;) {
+      while (links[i].next != nullptr &&
+             compare_(links[i].next->value, value)) {
+        position += links[i].width;
+        links = links[i].next->links();
+      }
+    }
+    return position;
+  }
+  const_iterator lower_bound(const value_type& value) const {
+    return const_iterator(lower_bound_node(value));
+  }
+
+  value_type min() const {
+    require_nonempty("SkipList::min()");
+    return head_[0].next->value;
+  }
+  value_type max() const {
+    require_nonempty("SkipList::max()");
+    return retrieve(size_ - 1);
+  }
+
+  template <typename Function>
+  void traverse(Function func) const {
+    for (const Node* node = head_[0].next; node != nullptr;
+         node = node->links()[0].next) {
+      func(node->value);
+    }
+  }
+
+protected:
+  static const size_type max_level = 32;
+  static const std::uint64_t default_seed = 0x9e3779b97f4a7c15ULL;
+
+  struct Link {
+    Node* next;
+    // Number of level-0 steps from the owner of this link to next, where
+    // a null next stands for the position just past the last element.
+    size_type width;
+  };
+  // The links of a node are allocated right behind it.
+  struct Node {
+    Node(size_type h, const Tp& x) : value(x), height(h) {}
+    Link* links() { return reinterpret_cast<Link*>(this + 1); }
+    const Link* links() const {
+      return reinterpret_cast<const Link*>(this + 1);
+    }
+    Tp value;
+    size_type height;
+  };
+  static_assert(alignof(Node) >= alignof(Link),
+                "links must be aligned when placed behind a node");
+
+  template <typename Reference, typename Pointer>
+  class Iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Tp value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Pointer pointer;
+    typedef Reference reference;
+
+    Iterator() : node_(nullptr) {}
+
+    reference operator*() const { return node_->value; }
+    pointer operator->() const { return &node_->value; }
+    Iterator& operator++() {
+      node_ = node_->links()[0].next;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const Iterator& rhs) const { return node_ == rhs.node_; }
+    bool operator!=(const Iterator& rhs) const { return node_ != rhs.node_; }
+
+  private:
+    friend class SkipList;
+    explicit Iterator(const Node* node) : node_(node) {}
+    const Node* node_;
+  };
+
+  static Node* create_node(size_type height, const Tp& value) {
+    void* memory = ::operator new(sizeof(Node) + height * sizeof(Link));
+    Node* node = nullptr;
+    try {
+      node = ::new (memory) Node(height, value);
+    } catch (...) {
+      ::operator delete(memory);
+      throw;
+    }
+    for (size_type i = 0; i < height; ++i) {
+      ::new (static_cast<void*>(&node->links()[i])) Link();
+      node->links()[i].next = nullptr;
+      node->links()[i].width = 0;
+    }
+    return node;
+  }
+  static void destroy_node(Node* node) {
+    node->~Node();
+    ::operator delete(static_cast<void*>(node));
+  }
+  void reset_head() {
+    for (size_type i = 0; i < max_level; ++i) {
+      head_[i].next = nullptr;
+      head_[i].width = size_ + 1;
+    }
+  }
+  size_type random_height() {
+    // xorshift64; two random bits per level give p = 1/4.
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 7;
+    seed_ ^= seed_ << 17;
+    std::uint64_t bits = seed_;
+    size_type height = 1;
+    while (height < max_level && (bits & 3) == 0) {
+      ++height;
+      bits >>= 2;
+    }
+    return height;
+  }
+  // Fills update[i] with the last link at level i that precedes value and
+  // position[i] with the position of its owner; returns the first node not
+  // less than value.
+  Node* search(const value_type& value, Link** update, size_type* position) {
+    Link* links = head_;
+    size_type current = 0;
+    for (size_type i = max_level; i-- > 0;) {
+      if (i < level_) {
+        while (links[i].next != nullptr &&
+               compare_(links[i].next->value, value)) {
+          current += links[i].width;
+          links = links[i].next->links();
+        }
+      }
+      update[i] = &links[i];
+      position[i] = current;
+    }
+    return links[0].next;
+  }
+  const Node* lower_bound_node(const value_type& value) const {
+    const Link* links = head_;
+    for (size_type i = level_; i-- > 0;) {
+      while (links[i].next != nullptr &&
+             compare_(links[i].next->value, value)) {
+        links = links[i].next->links();
+      }
+    }
+    return links[0].next;
+  }
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the list is empty.");
+    }
+  }
+  void check_range_inclusive_exclusive(const size_type& index) const {
+    if (index >= size_) {
+      throw std::out_of_range(
+        "SkipList range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size_) + ").");
+    }
+  }
+
+  size_type size_;
+  size_type level_;
+  std::uint64_t seed_;
+  Compare compare_;
+  Link head_[max_level];
+};
+
+#endif  // SKIP_LIST_H_
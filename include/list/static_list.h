@@ -22,6 +22,7 @@
 #ifndef LIST_H_
 #define LIST_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <initializer_list>
 #include <stdexcept>
@@ -78,21 +79,16 @@ public:
   value_type remove(const size_type& index) {
     require_nonempty("List::remove()");
     check_range_inclusive_exclusive(index);
-    value_type removed_value = container_[index];
-    for (size_type i = index; i < size_ - 1; ++i) {
-      container_[i] = container_[i + 1];
-    }
+    value_type removed_value = std::move(container_[index]);
+    std::move(container_ + index + 1, container_ + size_, container_ + index);
     --size_;
     return removed_value;
   }
   void insert(const size_type& index, const value_type& value) {
     require_nonfull("List::insert()");
     check_range_inclusive_inclusive(index);
-    if (size_ >= 1) {
-      for (size_type i = size_ - 1; i >= index; --i) {
-        container_[i + 1] = container_[i];
-      }
-    }
+    std::move_backward(container_ + index, container_ + size_,
+                       container_ + size_ + 1);
     container_[index] = value;
     ++size_;
   }
@@ -0,0 +1,522 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef UNROLLED_LIST_H_
+#define UNROLLED_LIST_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Sequence stored as a list of blocks, each an array of up to
+ * block_capacity elements (256 bytes of elements by default, i.e. four
+ * cache lines). Scans walk contiguous memory, and an insertion or removal
+ * only shifts the elements of one block.
+ *
+ * A full block is split in half before an insertion. A block that drops
+ * below a quarter of its capacity is merged with a neighbour when the two
+ * fit in three quarters of a block, which leaves room for the next few
+ * insertions without an immediate split.
+ *
+ * Positions are resolved by binary search over the element count before
+ * each block. Every edit adjusts the counts of the blocks after its own,
+ * so const members only read them and may run concurrently.
+ *
+ * The blocks are held in a vector of pointers, so an edit costs
+ * O(block_capacity + n / block_capacity): it shifts elements within one
+ * block, the counts after it, and on a split or merge the block pointers
+ * after it. With the default capacity the latter two are still far
+ * cheaper than moving the elements themselves.
+ *
+ * Iterators are invalidated by every insertion and removal.
+ */
+template <typename Tp, std::size_t block_capacity =
+          (sizeof(Tp) < 64 ? 256 / sizeof(Tp) : 4)>
+class UnrolledList {
+  static_assert(block_capacity >= 4, "block_capacity must be at least 4.");
+
+protected:
+  template <typename Reference, typename Pointer>
+  class Iterator;
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+  typedef Iterator<Tp&, Tp*> iterator;
+  typedef Iterator<const Tp&, const Tp*> const_iterator;
+
+  UnrolledList() : size_(0) {}
+  UnrolledList(const UnrolledList& other) : size_(0) {
+    for (const value_type& element : other) {
+      emplace_back(element);
+    }
+  }
+  UnrolledList(UnrolledList&& other) : size_(0) {
+    swap(other);
+  }
+  UnrolledList(const std::initializer_list<value_type>& il) : size_(0) {
+    for (const value_type& element : il) {
+      emplace_back(element);
+    }
+  }
+  UnrolledList& operator=(const UnrolledList& rhs) {
+    UnrolledList copy(rhs);
+    swap(copy);
+    return *this;
+  }
+  UnrolledList& operator=(UnrolledList&& rhs) {
+    swap(rhs);
+    return *this;
+  }
+  UnrolledList& operator=(const std::initializer_list<value_type>& il) {
+    UnrolledList copy(il);
+    swap(copy);
+    return *this;
+  }
+  virtual ~UnrolledList() { clear(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  void clear() {
+    for (Block* block : blocks_) {
+      destroy_block(block);
+    }
+    blocks_.clear();
+    offsets_.clear();
+    size_ = 0;
+  }
+  void swap(UnrolledList& other) {
+    std::swap(size_, other.size_);
+    blocks_.swap(other.blocks_);
+    offsets_.swap(other.offsets_);
+  }
+
+  iterator begin() { return iterator(this, 0, 0); }
+  const_iterator begin() const { return const_iterator(this, 0, 0); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(this, blocks_.size(), 0); }
+  const_iterator end() const {
+    return const_iterator(this, blocks_.size(), 0);
+  }
+  const_iterator cend() const { return end(); }
+
+  reference front() {
+    require_nonempty("UnrolledList::front()");
+    return blocks_.front()->data()[0];
+  }
+  const_reference front() const {
+    require_nonempty("UnrolledList::front()");
+    return blocks_.front()->data()[0];
+  }
+  reference back() {
+    require_nonempty("UnrolledList::back()");
+    return blocks_.back()->data()[blocks_.back()->count - 1];
+  }
+  const_reference back() const {
+    require_nonempty("UnrolledList::back()");
+    return blocks_.back()->data()[blocks_.back()->count - 1];
+  }
+
+  reference operator[](size_type index) { return *to_element(index); }
+  const_reference operator[](size_type index) const {
+    return *to_element(index);
+  }
+  const_reference retrieve(const size_type& index) const {
+    require_nonempty("UnrolledList::retrieve()");
+    check_range_inclusive_exclusive(index);
+    return *to_element(index);
+  }
+  void replace(const size_type& index, const value_type& value) {
+    require_nonempty("UnrolledList::replace()");
+    check_range_inclusive_exclusive(index);
+    *to_element(index) = value;
+  }
+  value_type remove(const size_type& index) {
+    require_nonempty("UnrolledList::remove()");
+    check_range_inclusive_exclusive(index);
+    size_type block_index = block_of(index);
+    size_type offset = index - offsets_[block_index];
+    value_type removed_value =
+      std::move(blocks_[block_index]->data()[offset]);
+    erase_at(block_index, offset);
+    return removed_value;
+  }
+  void insert(const size_type& index, const value_type& value) {
+    check_range_inclusive_inclusive(index);
+    if (index == size_) {
+      emplace_back(value);
+    } else {
+      size_type block_index = block_of(index);
+      size_type offset = index - offsets_[block_index];
+      emplace_at(block_index, offset, value);
+    }
+  }
+
+  template <typename... Args>
+  iterator emplace(const_iterator position, Args&&... args) {
+    if (position.block_index_ == blocks_.size()) {
+      emplace_back(std::forward<Args>(args)...);
+      return iterator(this, blocks_.size() - 1, blocks_.back()->count - 1);
+    }
+    size_type block_index = position.block_index_;
+    size_type offset = position.offset_;
+    emplace_at(block_index, offset, std::forward<Args>(args)...);
+    return iterator(this, block_index, offset);
+  }
+  iterator insert(const_iterator position, const value_type& value) {
+    return emplace(position, value);
+  }
+  iterator insert(const_iterator position, value_type&& value) {
+    return emplace(position, std::move(value));
+  }
+  // Returns the iterator following the removed element.
+  iterator erase(const_iterator position) {
+    if (position.block_index_ == blocks_.size()) {
+      throw std::out_of_range(
+        "UnrolledList::erase() is undefined for end().");
+    }
+    size_type block_index = position.block_index_;
+    size_type offset = position.offset_;
+    erase_at(block_index, offset);
+    return iterator(this, block_index, offset);
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (blocks_.empty() || blocks_.back()->count == block_capacity) {
+      insert_block(blocks_.size());
+    }
+    Block* block = blocks_.back();
+    Tp* target = block->data() + block->count;
+    try {
+      ::new (static_cast<void*>(target)) Tp(std::forward<Args>(args)...);
+    } catch (...) {
+      if (block->count == 0) {
+        erase_block(blocks_.size() - 1);
+      }
+      throw;
+    }
+    ++block->count;
+    ++size_;
+    return *target;
+  }
+  template <typename... Args>
+  reference emplace_front(Args&&... args) {
+    if (blocks_.empty()) {
+      return emplace_back(std::forward<Args>(args)...);
+    }
+    size_type block_index = 0, offset = 0;
+    emplace_at(block_index, offset, std::forward<Args>(args)...);
+    return blocks_[block_index]->data()[offset];
+  }
+  void push_back(const value_type& value) { emplace_back(value); }
+  void push_back(value_type&& value) { emplace_back(std::move(value)); }
+  void push_front(const value_type& value) { emplace_front(value); }
+  void push_front(value_type&& value) { emplace_front(std::move(value)); }
+  void pop_back() {
+    require_nonempty("UnrolledList::pop_back()");
+    size_type block_index = blocks_.size() - 1;
+    size_type offset = blocks_.back()->count - 1;
+    erase_at(block_index, offset);
+  }
+  void pop_front() {
+    require_nonempty("UnrolledList::pop_front()");
+    size_type block_index = 0, offset = 0;
+    erase_at(block_index, offset);
+  }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for (Block* block : blocks_) {
+      for (size_type i = 0; i < block->count; ++i) {
+        func(block->data()[i]);
+      }
+    }
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for (const Block* block : blocks_) {
+      for (size_type i = 0; i < block->count; ++i) {
+        func(block->data()[i]);
+      }
+    }
+  }
+
+protected:
+  struct Block {
+    Block() : count(0) {}
+    Tp* data() { return reinterpret_cast<Tp*>(storage); }
+    const Tp* data() const { return reinterpret_cast<const Tp*>(storage); }
+    typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type
+      storage[block_capacity];
+    size_type count;
+  };
+
+  template <typename Reference, typename Pointer>
+  class Iterator {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Tp value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Pointer pointer;
+    typedef Reference reference;
+
+    Iterator() : list_(nullptr), block_index_(0), offset_(0) {}
+    // Allows iterator to const_iterator conversion, but not the reverse.
+    template <typename OtherReference, typename OtherPointer,
+              typename = typename std::enable_if<
+                std::is_convertible<OtherPointer, Pointer>::value>::type>
+    Iterator(const Iterator<OtherReference, OtherPointer>& other) :
+      list_(other.list_), block_index_(other.block_index_),
+      offset_(other.offset_) {}
+
+    reference operator*() const {
+      return list_->blocks_[block_index_]->data()[offset_];
+    }
+    pointer operator->() const { return &**this; }
+    Iterator& operator++() {
+      if (++offset_ == list_->blocks_[block_index_]->count) {
+        ++block_index_;
+        offset_ = 0;
+      }
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    Iterator& operator--() {
+      if (offset_ == 0) {
+        --block_index_;
+        offset_ = list_->blocks_[block_index_]->count;
+      }
+      --offset_;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator old = *this;
+      --*this;
+      return old;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator==(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return block_index_ == rhs.block_index_ && offset_ == rhs.offset_;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator!=(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return !(*this == rhs);
+    }
+
+  private:
+    friend class UnrolledList;
+    template <typename, typename> friend class Iterator;
+    Iterator(const UnrolledList* list, size_type block_index,
+             size_type offset) :
+      list_(list), block_index_(block_index), offset_(offset) {}
+    const UnrolledList* list_;
+    size_type block_index_;
+    size_type offset_;
+  };
+
+  static void destroy_block(Block* block) {
+    for (size_type i = 0; i < block->count; ++i) {
+      block->data()[i].~Tp();
+    }
+    delete block;
+  }
+  // Inserts an empty block before blocks_[block_index].
+  void insert_block(size_type block_index) {
+    offsets_.insert(offsets_.begin() + block_index,
+                    block_index == 0 ? 0 : end_of(block_index - 1));
+    try {
+      blocks_.insert(blocks_.begin() + block_index, new Block());
+    } catch (...) {
+      offsets_.erase(offsets_.begin() + block_index);
+      throw;
+    }
+  }
+  // Removes a block that has been emptied.
+  void erase_block(size_type block_index) {
+    destroy_block(blocks_[block_index]);
+    blocks_.erase(blocks_.begin() + block_index);
+    offsets_.erase(offsets_.begin() + block_index);
+  }
+  // Applies a change in the size of blocks_[block_index] to the counts of
+  // the blocks after it.
+  void grow_offsets_after(size_type block_index) {
+    for (size_type k = block_index + 1; k < offsets_.size(); ++k) {
+      ++offsets_[k];
+    }
+  }
+  void shrink_offsets_after(size_type block_index) {
+    for (size_type k = block_index + 1; k < offsets_.size(); ++k) {
+      --offsets_[k];
+    }
+  }
+  // Moves count elements from the front of source to the back of target.
+  static void move_elements(Block* target, Block* source, size_type count) {
+    Tp* from = source->data();
+    Tp* to = target->data() + target->count;
+    for (size_type i = 0; i < count; ++i) {
+      ::new (static_cast<void*>(to + i)) Tp(std::move(from[i]));
+      ++target->count;
+    }
+    for (size_type i = count; i < source->count; ++i) {
+      from[i - count] = std::move(from[i]);
+    }
+    for (size_type i = source->count - count; i < source->count; ++i) {
+      from[i].~Tp();
+    }
+    source->count -= count;
+  }
+  // Moves the upper half of a full block into a new block after it.
+  void split(size_type block_index) {
+    insert_block(block_index + 1);
+    Block* lower = blocks_[block_index];
+    Block* upper = blocks_[block_index + 1];
+    size_type keep = lower->count / 2;
+    Tp* from = lower->data() + keep;
+    size_type moving = lower->count - keep;
+    for (size_type i = 0; i < moving; ++i) {
+      ::new (static_cast<void*>(upper->data() + i)) Tp(std::move(from[i]));
+      ++upper->count;
+    }
+    for (size_type i = 0; i < moving; ++i) {
+      from[i].~Tp();
+    }
+    lower->count = keep;
+    offsets_[block_index + 1] = offsets_[block_index] + keep;
+  }
+  // Inserts at the given offset of the given block, updating both to the
+  // final location of the new element.
+  template <typename... Args>
+  void emplace_at(size_type& block_index, size_type& offset,
+                  Args&&... args) {
+    Tp value(std::forward<Args>(args)...);
+    if (blocks_[block_index]->count == block_capacity) {
+      split(block_index);
+      if (offset > blocks_[block_index]->count) {
+        offset -= blocks_[block_index]->count;
+        ++block_index;
+      }
+    }
+    Block* block = blocks_[block_index];
+    Tp* data = block->data();
+    if (offset == block->count) {
+      ::new (static_cast<void*>(data + offset)) Tp(std::move(value));
+    } else {
+      ::new (static_cast<void*>(data + block->count))
+        Tp(std::move(data[block->count - 1]));
+      std::move_backward(data + offset, data + block->count - 1,
+                         data + block->count);
+      data[offset] = std::move(value);
+    }
+    ++block->count;
+    ++size_;
+    grow_offsets_after(block_index);
+  }
+  // Removes the element at the given offset of the given block, updating
+  // both to the location of the element that followed it.
+  void erase_at(size_type& block_index, size_type& offset) {
+    Block* block = blocks_[block_index];
+    Tp* data = block->data();
+    std::move(data + offset + 1, data + block->count, data + offset);
+    data[block->count - 1].~Tp();
+    --block->count;
+    --size_;
+    shrink_offsets_after(block_index);
+    if (block->count == 0) {
+      erase_block(block_index);
+      offset = 0;
+      return;
+    }
+    if (block->count < block_capacity / 4 && blocks_.size() > 1) {
+      size_type left = block_index + 1 < blocks_.size() ?
+                       block_index : block_index - 1;
+      Block* lower = blocks_[left];
+      Block* upper = blocks_[left + 1];
+      if (lower->count + upper->count <= block_capacity * 3 / 4) {
+        if (block_index != left) {
+          offset += lower->count;
+          block_index = left;
+        }
+        move_elements(lower, upper, upper->count);
+        erase_block(left + 1);
+      }
+    }
+    if (offset == blocks_[block_index]->count) {
+      ++block_index;
+      offset = 0;
+    }
+  }
+  // Index of the block holding the element at index < size_.
+  size_type block_of(size_type index) const {
+    return std::upper_bound(offsets_.begin(), offsets_.end(), index) -
+           offsets_.begin() - 1;
+  }
+  size_type end_of(size_type block_index) const {
+    return offsets_[block_index] + blocks_[block_index]->count;
+  }
+  Tp* to_element(size_type index) const {
+    size_type block_index = block_of(index);
+    return blocks_[block_index]->data() + (index - offsets_[block_index]);
+  }
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the list is empty.");
+    }
+  }
+  void check_range_inclusive_exclusive(const size_type& index) const {
+    if (index >= size_) {
+      throw std::out_of_range(
+        "UnrolledList range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size_) + ").");
+    }
+  }
+  void check_range_inclusive_inclusive(const size_type& index) const {
+    if (index > size_) {
+      throw std::out_of_range(
+        "UnrolledList range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size_) + "].");
+    }
+  }
+
+  size_type size_;
+  std::vector<Block*> blocks_;
+  // offsets_[i] is the number of elements before blocks_[i].
+  std::vector<size_type> offsets_;
+};
+
+#endif  // UNROLLED_LIST_H_
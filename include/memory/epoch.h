@@ -0,0 +1,216 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef EPOCH_H_
+#define EPOCH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/*
+ * Epoch-based memory reclamation for lock-free structures, shared by every
+ * structure in the process.
+ *
+ * A thread dereferences shared nodes only while it holds an EpochGuard,
+ * and passes nodes it has unlinked to Epoch::retire() instead of freeing
+ * them. The global epoch advances once every guarded thread has observed
+ * the current value, so a node retired in epoch e can no longer be
+ * reached by anyone when the epoch reaches e + 2, and is freed then.
+ *
+ * Each thread buffers its own retired nodes. What is still pending when a
+ * thread exits is adopted by whichever thread reclaims next.
+ */
+class Epoch {
+public:
+  typedef void (*Deleter)(void*);
+
+  static void enter() {
+    Local& local = this_thread();
+    if (local.depth++ > 0) {
+      return;
+    }
+    // Re-check after publishing: an epoch read before an advance that
+    // missed this record must not be the one we pin.
+    std::uint64_t epoch = global().epoch.load();
+    while (true) {
+      local.record->epoch.store(epoch);
+      std::uint64_t current = global().epoch.load();
+      if (current == epoch) {
+        break;
+      }
+      epoch = current;
+    }
+  }
+  static void leave() {
+    Local& local = this_thread();
+    if (--local.depth == 0) {
+      local.record->epoch.store(quiescent);
+    }
+  }
+
+  // Frees pointer with deleter once no guarded thread can still see it.
+  // The caller must already have made it unreachable.
+  static void retire(void* pointer, Deleter deleter) {
+    Local& local = this_thread();
+    local.retired.push_back(Retired(pointer, deleter, global().epoch.load()));
+    if (local.retired.size() >= reclaim_threshold) {
+      reclaim();
+    }
+  }
+  template <typename Tp>
+  static void retire(Tp* pointer) {
+    retire(pointer, &delete_object<Tp>);
+  }
+  // Advances the epoch if possible and frees whatever has become safe.
+  static void reclaim() {
+    Global& shared = global();
+    try_advance();
+    std::uint64_t epoch = shared.epoch.load();
+    free_expired(this_thread().retired, epoch);
+    std::unique_lock<std::mutex> lock(shared.orphans_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+      free_expired(shared.orphans, epoch);
+    }
+  }
+
+protected:
+  static const std::uint64_t quiescent = 0;
+  static const std::size_t reclaim_threshold = 64;
+
+  struct Retired {
+    Retired(void* p, Deleter d, std::uint64_t e) :
+      pointer(p), deleter(d), epoch(e) {}
+    void* pointer;
+    Deleter deleter;
+    std::uint64_t epoch;
+  };
+  // One per thread, reused after the thread exits; never freed before
+  // the process ends.
+  struct Record {
+    Record() : epoch(quiescent), in_use(true), next(nullptr) {}
+    std::atomic<std::uint64_t> epoch;
+    std::atomic<bool> in_use;
+    Record* next;
+  };
+  struct Global {
+    Global() : epoch(1), records(nullptr) {}
+    ~Global() {
+      for (const Retired& retired : orphans) {
+        retired.deleter(retired.pointer);
+      }
+      Record* record = records.load();
+      while (record != nullptr) {
+        Record* next = record->next;
+        delete record;
+        record = next;
+      }
+    }
+    std::atomic<std::uint64_t> epoch;
+    std::atomic<Record*> records;
+    std::mutex orphans_mutex;
+    std::vector<Retired> orphans;
+  };
+  struct Local {
+    Local() : record(acquire_record()), depth(0) {}
+    ~Local() {
+      Global& shared = global();
+      if (!retired.empty()) {
+        std::lock_guard<std::mutex> lock(shared.orphans_mutex);
+        shared.orphans.insert(shared.orphans.end(),
+                              retired.begin(), retired.end());
+      }
+      record->epoch.store(quiescent);
+      record->in_use.store(false);
+    }
+    Record* record;
+    std::size_t depth;
+    std::vector<Retired> retired;
+  };
+
+  static Global& global() {
+    static Global instance;
+    return instance;
+  }
+  static Local& this_thread() {
+    static thread_local Local instance;
+    return instance;
+  }
+  template <typename Tp>
+  static void delete_object(void* pointer) {
+    delete static_cast<Tp*>(pointer);
+  }
+
+  static Record* acquire_record() {
+    Global& shared = global();
+    for (Record* record = shared.records.load(); record != nullptr;
+         record = record->next) {
+      bool in_use = false;
+      if (!record->in_use.load() &&
+          record->in_use.compare_exchange_strong(in_use, true)) {
+        return record;
+      }
+    }
+    Record* record = new Record();
+    Record* head = shared.records.load();
+    do {
+      record->next = head;
+    } while (!shared.records.compare_exchange_weak(head, record));
+    return record;
+  }
+  static void try_advance() {
+    Global& shared = global();
+    std::uint64_t epoch = shared.epoch.load();
+    for (Record* record = shared.records.load(); record != nullptr;
+         record = record->next) {
+      std::uint64_t observed = record->epoch.load();
+      if (observed != quiescent && observed != epoch) {
+        return;
+      }
+    }
+    shared.epoch.compare_exchange_strong(epoch, epoch + 1);
+  }
+  static void free_expired(std::vector<Retired>& retired,
+                           std::uint64_t epoch) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < retired.size(); ++i) {
+      if (retired[i].epoch + 2 <= epoch) {
+        retired[i].deleter(retired[i].pointer);
+      } else {
+        retired[kept++] = retired[i];
+      }
+    }
+    retired.resize(kept, Retired(nullptr, nullptr, 0));
+  }
+};
+
+// Keeps the calling thread inside an epoch for its lifetime. Guards nest.
+class EpochGuard {
+public:
+  EpochGuard() { Epoch::enter(); }
+  EpochGuard(const EpochGuard&) = delete;
+  EpochGuard& operator=(const EpochGuard&) = delete;
+  ~EpochGuard() { Epoch::leave(); }
+};
+
+#endif  // EPOCH_H_
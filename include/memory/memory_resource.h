@@ -0,0 +1,146 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef MEMORY_RESOURCE_H_
+#define MEMORY_RESOURCE_H_
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+
+/*
+ * MemoryResource is std::pmr::memory_resource when the standard library
+ * has it, so the resources in this directory plug straight into std::pmr
+ * containers and any std::pmr resource can back the containers here.
+ * Before C++17 it is a stand-in with the same interface.
+ */
+#if __cplusplus >= 201703L
+
+typedef std::pmr::memory_resource MemoryResource;
+
+inline MemoryResource* default_resource() {
+  return std::pmr::get_default_resource();
+}
+
+#else
+
+class MemoryResource {
+public:
+  virtual ~MemoryResource() {}
+
+  void* allocate(std::size_t bytes,
+                 std::size_t alignment = alignof(std::max_align_t)) {
+    return do_allocate(bytes, alignment);
+  }
+  void deallocate(void* pointer, std::size_t bytes,
+                  std::size_t alignment = alignof(std::max_align_t)) {
+    do_deallocate(pointer, bytes, alignment);
+  }
+  bool is_equal(const MemoryResource& other) const noexcept {
+    return do_is_equal(other);
+  }
+
+private:
+  virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+  virtual void do_deallocate(void* pointer, std::size_t bytes,
+                             std::size_t alignment) = 0;
+  virtual bool do_is_equal(const MemoryResource& other) const noexcept = 0;
+};
+
+inline bool operator==(const MemoryResource& lhs, const MemoryResource& rhs) {
+  return &lhs == &rhs || lhs.is_equal(rhs);
+}
+inline bool operator!=(const MemoryResource& lhs, const MemoryResource& rhs) {
+  return !(lhs == rhs);
+}
+
+// Forwards to global new and delete; alignments beyond
+// alignof(std::max_align_t) are not supported.
+class NewDeleteResource : public MemoryResource {
+private:
+  void* do_allocate(std::size_t bytes, std::size_t) override {
+    return ::operator new(bytes);
+  }
+  void do_deallocate(void* pointer, std::size_t, std::size_t) override {
+    ::operator delete(pointer);
+  }
+  bool do_is_equal(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+inline MemoryResource* default_resource() {
+  static NewDeleteResource instance;
+  return &instance;
+}
+
+#endif
+
+/*
+ * Allocator that draws from a MemoryResource, for the Alloc parameter of
+ * the containers in this repository. Unlike std::pmr::polymorphic_allocator
+ * it is kept by copies of a container, so a copy of an arena-backed tree
+ * lives in the same arena.
+ */
+template <typename Tp>
+class ResourceAllocator {
+public:
+  typedef Tp value_type;
+
+  ResourceAllocator() noexcept : resource_(default_resource()) {}
+  ResourceAllocator(MemoryResource* resource) noexcept :
+    resource_(resource) {}
+  template <typename Up>
+  ResourceAllocator(const ResourceAllocator<Up>& other) noexcept :
+    resource_(other.resource()) {}
+
+  Tp* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(Tp)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<Tp*>(resource_->allocate(n * sizeof(Tp), alignof(Tp)));
+  }
+  void deallocate(Tp* pointer, std::size_t n) {
+    resource_->deallocate(pointer, n * sizeof(Tp), alignof(Tp));
+  }
+
+  MemoryResource* resource() const noexcept { return resource_; }
+
+private:
+  MemoryResource* resource_;
+};
+
+template <typename Tp, typename Up>
+bool operator==(const ResourceAllocator<Tp>& lhs,
+                const ResourceAllocator<Up>& rhs) noexcept {
+  return *lhs.resource() == *rhs.resource();
+}
+template <typename Tp, typename Up>
+bool operator!=(const ResourceAllocator<Tp>& lhs,
+                const ResourceAllocator<Up>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+#endif  // MEMORY_RESOURCE_H_
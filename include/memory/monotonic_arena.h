@@ -0,0 +1,138 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef MONOTONIC_ARENA_H_
+#define MONOTONIC_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "memory/memory_resource.h"
+
+/*
+ * Bump allocator: every allocation is carved off the end of the current
+ * block, and deallocation does nothing. Blocks are taken from the
+ * upstream resource, each twice the size of the previous one, and are
+ * all returned at once by release() or the destructor. Suited to
+ * request-scoped structures that are built, used and dropped together.
+ *
+ * An optional initial buffer supplied by the caller is used first and
+ * never freed. Not thread-safe.
+ */
+class MonotonicArena : public MemoryResource {
+public:
+  typedef std::size_t size_type;
+
+  explicit MonotonicArena(size_type initial_size = 1024,
+                          MemoryResource* upstream = default_resource()) :
+    upstream_(upstream), blocks_(nullptr), buffer_(nullptr),
+    buffer_size_(0), current_(0), end_(0),
+    initial_size_(at_least_min_block(initial_size)),
+    next_size_(initial_size_) {}
+  MonotonicArena(void* buffer, size_type size,
+                 MemoryResource* upstream = default_resource()) :
+    upstream_(upstream), blocks_(nullptr), buffer_(buffer),
+    buffer_size_(size), current_(0), end_(0),
+    initial_size_(at_least_min_block(size)),
+    next_size_(initial_size_) {
+    reset_buffer();
+  }
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+  virtual ~MonotonicArena() { release(); }
+
+  // Returns every block to the upstream resource. Everything allocated
+  // from the arena is invalidated at once.
+  void release() {
+    while (blocks_ != nullptr) {
+      Block* next = blocks_->next;
+      upstream_->deallocate(blocks_, blocks_->size, alignof(Block));
+      blocks_ = next;
+    }
+    next_size_ = initial_size_;
+    reset_buffer();
+  }
+  MemoryResource* upstream_resource() const { return upstream_; }
+
+protected:
+  static const size_type min_block_size = 64;
+
+  struct Block {
+    Block* next;
+    size_type size;
+  };
+
+  void* do_allocate(size_type bytes, size_type alignment) override {
+    std::uintptr_t aligned = align_up(current_, alignment);
+    if (end_ == 0 || aligned < current_ || aligned > end_ ||
+        end_ - aligned < bytes) {
+      add_block(bytes, alignment);
+      aligned = align_up(current_, alignment);
+    }
+    current_ = aligned + bytes;
+    return reinterpret_cast<void*>(aligned);
+  }
+  void do_deallocate(void*, size_type, size_type) override {}
+  bool do_is_equal(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+
+  static size_type at_least_min_block(size_type size) {
+    return size < min_block_size ? size_type(min_block_size) : size;
+  }
+  static std::uintptr_t align_up(std::uintptr_t address,
+                                 size_type alignment) {
+    return (address + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+  }
+  void reset_buffer() {
+    current_ = reinterpret_cast<std::uintptr_t>(buffer_);
+    end_ = current_ + (buffer_ == nullptr ? 0 : buffer_size_);
+  }
+  // Large requests get a block of their own size, so the geometric
+  // growth is not thrown off by one outlier.
+  void add_block(size_type bytes, size_type alignment) {
+    size_type needed = sizeof(Block) + bytes + alignment;
+    size_type size = next_size_ < needed ? needed : next_size_;
+    Block* block = static_cast<Block*>(upstream_->allocate(size,
+                                                           alignof(Block)));
+    block->next = blocks_;
+    block->size = size;
+    blocks_ = block;
+    current_ = reinterpret_cast<std::uintptr_t>(block + 1);
+    end_ = reinterpret_cast<std::uintptr_t>(block) + size;
+    if (size == next_size_) {
+      next_size_ *= 2;
+    }
+  }
+
+  MemoryResource* upstream_;
+  // Newest first.
+  Block* blocks_;
+  void* buffer_;
+  size_type buffer_size_;
+  // The free part of the current block or buffer is [current_, end_).
+  std::uintptr_t current_;
+  std::uintptr_t end_;
+  size_type initial_size_;
+  size_type next_size_;
+};
+
+#endif  // MONOTONIC_ARENA_H_
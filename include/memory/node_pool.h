@@ -0,0 +1,246 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef NODE_POOL_H_
+#define NODE_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Exchanges two allocators even when they cannot be assigned, as with
+// std::pmr::polymorphic_allocator. The containers built on NodePool always
+// move their allocator along with the memory it handed out.
+template <typename Alloc>
+void swap_allocators(Alloc& lhs, Alloc& rhs) {
+  Alloc copy(lhs);
+  lhs.~Alloc();
+  ::new (static_cast<void*>(&lhs)) Alloc(rhs);
+  rhs.~Alloc();
+  ::new (static_cast<void*>(&rhs)) Alloc(copy);
+}
+
+/*
+ * Slab allocator for the nodes of one container. Nodes are carved out of
+ * slabs that double in size from min_slab_size up to max_slab_size, and
+ * destroyed nodes go on a free list for reuse. Memory is only returned
+ * when the pool is released or destroyed, which frees whole slabs at once.
+ * Slabs are obtained from Alloc, so a pool on an arena allocator makes no
+ * calls to the global heap at all.
+ *
+ * Not thread-safe: a pool belongs to one container.
+ */
+template <typename Node, typename Alloc = std::allocator<Node>,
+          std::size_t min_slab_size = 16, std::size_t max_slab_size = 1024>
+class NodePool {
+protected:
+  union Block;
+
+public:
+  typedef std::size_t size_type;
+  typedef Alloc allocator_type;
+
+  explicit NodePool(const Alloc& alloc = Alloc()) :
+    free_list_(nullptr), free_tail_(nullptr), slabs_(nullptr),
+    oldest_slab_(nullptr), bump_(0), bump_end_(0),
+    next_slab_size_(min_slab_size), live_(0), alloc_(alloc) {}
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+  NodePool(NodePool&& other) : NodePool(other.get_allocator()) {
+    swap(other);
+  }
+  NodePool& operator=(NodePool&& rhs) {
+    swap(rhs);
+    return *this;
+  }
+  virtual ~NodePool() { release(); }
+
+  // Number of nodes created and not yet destroyed.
+  size_type live() const { return live_; }
+  allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+  template <typename... Args>
+  Node* create(Args&&... args) {
+    void* block = allocate();
+    try {
+      Node* node = ::new (block) Node(std::forward<Args>(args)...);
+      ++live_;
+      return node;
+    } catch (...) {
+      deallocate(block);
+      throw;
+    }
+  }
+  void destroy(Node* node) {
+    node->~Node();
+    deallocate(node);
+    --live_;
+  }
+  // Destroys the chain of nodes starting at first and linked through next,
+  // which must hold every live node of the pool. Nodes with a trivial
+  // destructor are not visited at all: the slabs are released in bulk.
+  void destroy_all(Node* first, Node* Node::*next) {
+    if (std::is_trivially_destructible<Node>::value) {
+      release();
+      return;
+    }
+    while (first != nullptr) {
+      Node* following = first->*next;
+      destroy(first);
+      first = following;
+    }
+  }
+  // Frees every slab without running node destructors; the caller must
+  // have destroyed the live nodes already unless Node is trivially
+  // destructible.
+  void release() {
+    while (slabs_ != nullptr) {
+      Slab* next = slabs_->next;
+      BlockAllocatorTraits::deallocate(alloc_, reinterpret_cast<Block*>(slabs_),
+                                       header_blocks + slabs_->capacity);
+      slabs_ = next;
+    }
+    free_list_ = free_tail_ = nullptr;
+    oldest_slab_ = nullptr;
+    bump_ = bump_end_ = 0;
+    next_slab_size_ = min_slab_size;
+    live_ = 0;
+  }
+  void swap(NodePool& other) {
+    std::swap(free_list_, other.free_list_);
+    std::swap(free_tail_, other.free_tail_);
+    std::swap(slabs_, other.slabs_);
+    std::swap(oldest_slab_, other.oldest_slab_);
+    std::swap(bump_, other.bump_);
+    std::swap(bump_end_, other.bump_end_);
+    std::swap(next_slab_size_, other.next_slab_size_);
+    std::swap(live_, other.live_);
+    swap_allocators(alloc_, other.alloc_);
+  }
+  // Takes over the slabs, free blocks and live nodes of other, leaving it
+  // empty. Nodes created by other may then be destroyed through this pool.
+  // Both pools must allocate from equal allocators.
+  void merge(NodePool& other) {
+    if (&other == this || other.slabs_ == nullptr) {
+      return;
+    }
+    if (!(alloc_ == other.alloc_)) {
+      throw std::invalid_argument(
+        "NodePool::merge() is undefined for pools with unequal allocators.");
+    }
+    if (slabs_ == nullptr) {
+      swap(other);
+      return;
+    }
+    while (other.bump_ < other.bump_end_) {
+      deallocate(&other.slabs_->blocks()[other.bump_++]);
+    }
+    if (other.free_list_ != nullptr) {
+      other.free_tail_->next = free_list_;
+      if (free_list_ == nullptr) {
+        free_tail_ = other.free_tail_;
+      }
+      free_list_ = other.free_list_;
+    }
+    oldest_slab_->next = other.slabs_;
+    oldest_slab_ = other.oldest_slab_;
+    live_ += other.live_;
+    other.free_list_ = other.free_tail_ = nullptr;
+    other.slabs_ = other.oldest_slab_ = nullptr;
+    other.bump_ = other.bump_end_ = 0;
+    other.live_ = 0;
+  }
+
+protected:
+  union Block {
+    Block* next;
+    typename std::aligned_storage<sizeof(Node), alignof(Node)>::type storage;
+  };
+  // A slab is an array of blocks whose first header_blocks blocks hold
+  // this header.
+  struct Slab {
+    Slab* next;
+    size_type capacity;
+    Block* blocks() { return reinterpret_cast<Block*>(this) + header_blocks; }
+  };
+  static const size_type header_blocks =
+    (sizeof(Slab) + sizeof(Block) - 1) / sizeof(Block);
+  typedef typename std::allocator_traits<Alloc>::template
+    rebind_alloc<Block> BlockAllocator;
+  typedef std::allocator_traits<BlockAllocator> BlockAllocatorTraits;
+
+  void* allocate() {
+    if (free_list_ != nullptr) {
+      Block* block = free_list_;
+      free_list_ = block->next;
+      if (free_list_ == nullptr) {
+        free_tail_ = nullptr;
+      }
+      return block;
+    }
+    if (bump_ == bump_end_) {
+      add_slab();
+    }
+    return &slabs_->blocks()[bump_++];
+  }
+  void deallocate(void* pointer) {
+    Block* block = static_cast<Block*>(pointer);
+    block->next = free_list_;
+    if (free_list_ == nullptr) {
+      free_tail_ = block;
+    }
+    free_list_ = block;
+  }
+  void add_slab() {
+    size_type capacity = next_slab_size_;
+    Block* memory = BlockAllocatorTraits::allocate(alloc_,
+                                                   header_blocks + capacity);
+    Slab* slab = ::new (static_cast<void*>(memory)) Slab;
+    slab->next = slabs_;
+    slab->capacity = capacity;
+    if (slabs_ == nullptr) {
+      oldest_slab_ = slab;
+    }
+    slabs_ = slab;
+    bump_ = 0;
+    bump_end_ = capacity;
+    if (next_slab_size_ < max_slab_size) {
+      next_slab_size_ *= 2;
+    }
+  }
+
+  Block* free_list_;
+  Block* free_tail_;
+  // Newest first; the bump region lies in the newest slab.
+  Slab* slabs_;
+  Slab* oldest_slab_;
+  // Blocks of the newest slab that were never handed out.
+  size_type bump_;
+  size_type bump_end_;
+  size_type next_slab_size_;
+  size_type live_;
+  BlockAllocator alloc_;
+};
+
+#endif  // NODE_POOL_H_
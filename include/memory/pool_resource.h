@@ -0,0 +1,173 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef POOL_RESOURCE_H_
+#define POOL_RESOURCE_H_
+
+#include <cstddef>
+
+#include "memory/memory_resource.h"
+
+/*
+ * Memory resource with one free list per size class. Requests are
+ * rounded up to a power of two between 8 and max_block_size bytes; each
+ * class carves its blocks out of chunks taken from the upstream resource,
+ * doubling the chunk each time up to max_chunk_blocks blocks. Freed
+ * blocks are reused by the same class, and chunks go back upstream only
+ * on release() or destruction. Larger or over-aligned requests are passed
+ * to the upstream resource directly.
+ *
+ * Not thread-safe, like std::pmr::unsynchronized_pool_resource.
+ */
+class PoolResource : public MemoryResource {
+public:
+  typedef std::size_t size_type;
+
+  static const size_type max_block_size = 4096;
+  static const size_type max_chunk_blocks = 1024;
+
+  explicit PoolResource(MemoryResource* upstream = default_resource()) :
+    upstream_(upstream) {
+    for (size_type i = 0; i < class_count; ++i) {
+      classes_[i].free_list = nullptr;
+      classes_[i].chunks = nullptr;
+      classes_[i].next_chunk_blocks = min_chunk_blocks;
+    }
+  }
+  PoolResource(const PoolResource&) = delete;
+  PoolResource& operator=(const PoolResource&) = delete;
+  virtual ~PoolResource() { release(); }
+
+  // Returns every chunk to the upstream resource, invalidating all blocks
+  // handed out by the pools. Large blocks passed through to the upstream
+  // resource are not tracked and must be deallocated by their owners.
+  void release() {
+    for (size_type i = 0; i < class_count; ++i) {
+      SizeClass& size_class = classes_[i];
+      while (size_class.chunks != nullptr) {
+        Chunk* next = size_class.chunks->next;
+        upstream_->deallocate(size_class.chunks, size_class.chunks->bytes,
+                              chunk_alignment);
+        size_class.chunks = next;
+      }
+      size_class.free_list = nullptr;
+      size_class.next_chunk_blocks = min_chunk_blocks;
+    }
+  }
+  MemoryResource* upstream_resource() const { return upstream_; }
+
+protected:
+  static const size_type min_block_shift = 3;
+  static const size_type class_count = 10;
+  static const size_type min_chunk_blocks = 16;
+  static const size_type chunk_alignment = alignof(std::max_align_t);
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  // Header of every chunk; blocks start at chunk_header_size().
+  struct Chunk {
+    Chunk* next;
+    size_type bytes;
+  };
+  struct SizeClass {
+    FreeBlock* free_list;
+    Chunk* chunks;
+    size_type next_chunk_blocks;
+  };
+
+  static size_type chunk_header_size() {
+    return (sizeof(Chunk) + chunk_alignment - 1) / chunk_alignment *
+           chunk_alignment;
+  }
+  // Index of the smallest class that fits bytes at the given alignment,
+  // or class_count if none does. A block of class i is 8 << i bytes and
+  // aligned to the smaller of its size and chunk_alignment.
+  static size_type class_index(size_type bytes, size_type alignment) {
+    if (alignment > chunk_alignment) {
+      return class_count;
+    }
+    size_type needed = bytes < alignment ? alignment : bytes;
+    size_type index = 0;
+    while (index < class_count &&
+           (size_type(1) << (index + min_block_shift)) < needed) {
+      ++index;
+    }
+    return index;
+  }
+
+  void* do_allocate(size_type bytes, size_type alignment) override {
+    size_type index = class_index(bytes, alignment);
+    if (index == class_count) {
+      return upstream_->allocate(bytes, alignment);
+    }
+    SizeClass& size_class = classes_[index];
+    if (size_class.free_list == nullptr) {
+      add_chunk(size_class, size_type(1) << (index + min_block_shift));
+    }
+    FreeBlock* block = size_class.free_list;
+    size_class.free_list = block->next;
+    return block;
+  }
+  void do_deallocate(void* pointer, size_type bytes,
+                     size_type alignment) override {
+    size_type index = class_index(bytes, alignment);
+    if (index == class_count) {
+      upstream_->deallocate(pointer, bytes, alignment);
+      return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = classes_[index].free_list;
+    classes_[index].free_list = block;
+  }
+  bool do_is_equal(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+
+  // Threads the blocks of a new chunk onto the free list, lowest address
+  // first so that consecutive allocations are adjacent.
+  void add_chunk(SizeClass& size_class, size_type block_size) {
+    size_type blocks = size_class.next_chunk_blocks;
+    size_type bytes = chunk_header_size() + blocks * block_size;
+    Chunk* chunk = static_cast<Chunk*>(upstream_->allocate(bytes,
+                                                           chunk_alignment));
+    chunk->next = size_class.chunks;
+    chunk->bytes = bytes;
+    size_class.chunks = chunk;
+    char* first = reinterpret_cast<char*>(chunk) + chunk_header_size();
+    for (size_type i = blocks; i-- > 0;) {
+      FreeBlock* block = reinterpret_cast<FreeBlock*>(first + i * block_size);
+      block->next = size_class.free_list;
+      size_class.free_list = block;
+    }
+    if (blocks < max_chunk_blocks) {
+      size_class.next_chunk_blocks = blocks * 2;
+    }
+  }
+
+  MemoryResource* upstream_;
+  SizeClass classes_[class_count];
+
+  static_assert((size_type(1) << (min_block_shift + class_count - 1)) ==
+                max_block_size, "the largest class must be max_block_size");
+};
+
+#endif  // POOL_RESOURCE_H_
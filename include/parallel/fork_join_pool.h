@@ -0,0 +1,260 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef FORK_JOIN_POOL_H_
+#define FORK_JOIN_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "queue/work_stealing_deque.h"
+
+/*
+ * Fork-join thread pool. Each worker owns a WorkStealingDeque of tasks:
+ * fork_join() pushes the right half at the bottom of the caller's deque
+ * and runs the left half inline, while idle workers steal from the top of
+ * randomly chosen victims. A worker whose right half was stolen keeps
+ * stealing other work until the thief finishes it.
+ *
+ * invoke() runs a function on the pool from an outside thread and blocks
+ * until it returns. Exceptions thrown by tasks propagate to the joiner.
+ */
+class ForkJoinPool {
+public:
+  typedef std::size_t size_type;
+
+  explicit ForkJoinPool(size_type num_threads = default_num_threads()) :
+    stop_(false), idle_count_(0) {
+    if (num_threads == 0) {
+      num_threads = 1;
+    }
+    for (size_type i = 0; i < num_threads; ++i) {
+      workers_.emplace_back(new Worker(i));
+    }
+    for (size_type i = 0; i < num_threads; ++i) {
+      threads_.emplace_back(&ForkJoinPool::run_worker, this, i);
+    }
+  }
+  ForkJoinPool(const ForkJoinPool&) = delete;
+  ForkJoinPool& operator=(const ForkJoinPool&) = delete;
+  virtual ~ForkJoinPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  size_type num_threads() const { return workers_.size(); }
+  static size_type default_num_threads() {
+    size_type n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+  }
+
+  template <typename Function>
+  void invoke(Function&& func) {
+    if (current_worker() != nullptr) {
+      func();
+      return;
+    }
+    FunctionTask<Function> task(func);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      injected_.push_back(&task);
+      wake_.notify_one();
+      completed_.wait(lock, [&task]() {
+        return task.done.load(std::memory_order_acquire);
+      });
+    }
+    task.rethrow_if_failed();
+  }
+  template <typename LeftFunction, typename RightFunction>
+  void fork_join(LeftFunction&& left, RightFunction&& right) {
+    Worker* worker = current_worker();
+    if (worker == nullptr) {
+      invoke([&]() { fork_join(left, right); });
+      return;
+    }
+    FunctionTask<RightFunction> right_task(right);
+    worker->deque.push(&right_task);
+    if (idle_count_.load(std::memory_order_relaxed) > 0) {
+      wake_.notify_one();
+    }
+    std::exception_ptr left_error;
+    try {
+      left();
+    } catch (...) {
+      left_error = std::current_exception();
+    }
+    Task* task = nullptr;
+    if (worker->deque.pop(task)) {
+      // Nested fork_join calls have drained everything pushed above us,
+      // so the bottom of the deque is our own right half.
+      task->execute();
+    } else {
+      help_until_done(*worker, right_task);
+    }
+    if (left_error) {
+      std::rethrow_exception(left_error);
+    }
+    right_task.rethrow_if_failed();
+  }
+
+protected:
+  struct Task {
+    Task() : done(false) {}
+    virtual ~Task() {}
+    virtual void run() = 0;
+    void execute() {
+      try {
+        run();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      done.store(true, std::memory_order_release);
+    }
+    void rethrow_if_failed() {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+    std::atomic<bool> done;
+    std::exception_ptr error;
+  };
+  template <typename Function>
+  struct FunctionTask : Task {
+    explicit FunctionTask(Function& f) : func(f) {}
+    void run() override { func(); }
+    Function& func;
+  };
+  struct Worker {
+    explicit Worker(size_type i) : index(i), random(static_cast<
+      std::minstd_rand::result_type>(i + 1)) {}
+    size_type index;
+    WorkStealingDeque<Task*> deque;
+    std::minstd_rand random;
+  };
+  struct Context {
+    Context() : pool(nullptr), worker(nullptr) {}
+    ForkJoinPool* pool;
+    Worker* worker;
+  };
+
+  static Context& context() {
+    static thread_local Context current;
+    return current;
+  }
+  Worker* current_worker() const {
+    Context& current = context();
+    return current.pool == this ? current.worker : nullptr;
+  }
+
+  void run_worker(size_type index) {
+    Worker& worker = *workers_[index];
+    context().pool = this;
+    context().worker = &worker;
+    size_type failed_attempts = 0;
+    while (true) {
+      Task* task = nullptr;
+      if (worker.deque.pop(task) || steal(worker, task)) {
+        task->execute();
+        failed_attempts = 0;
+      } else if (take_injected(task)) {
+        task->execute();
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.notify_all();
+        failed_attempts = 0;
+      } else if (++failed_attempts < 64) {
+        std::this_thread::yield();
+      } else {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_) {
+          break;
+        }
+        if (injected_.empty()) {
+          idle_count_.fetch_add(1, std::memory_order_relaxed);
+          // Forks notify without the lock, so wake up periodically
+          // rather than relying on never missing a notification.
+          wake_.wait_for(lock, std::chrono::milliseconds(1));
+          idle_count_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        failed_attempts = 0;
+      }
+    }
+  }
+  bool steal(Worker& thief, Task*& task) {
+    size_type n = workers_.size();
+    if (n < 2) {
+      return false;
+    }
+    size_type start = static_cast<size_type>(thief.random()) % n;
+    for (size_type i = 0; i < n; ++i) {
+      Worker& victim = *workers_[(start + i) % n];
+      if (&victim != &thief && victim.deque.steal(task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool take_injected(Task*& task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (injected_.empty()) {
+      return false;
+    }
+    task = injected_.front();
+    injected_.pop_front();
+    return true;
+  }
+  void help_until_done(Worker& worker, const Task& awaited) {
+    while (!awaited.done.load(std::memory_order_acquire)) {
+      Task* task = nullptr;
+      if (worker.deque.pop(task) || steal(worker, task)) {
+        task->execute();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable completed_;
+  std::deque<Task*> injected_;
+  bool stop_;
+  std::atomic<size_type> idle_count_;
+};
+
+#endif  // FORK_JOIN_POOL_H_
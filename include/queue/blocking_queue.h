@@ -0,0 +1,318 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef BLOCKING_QUEUE_H_
+#define BLOCKING_QUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+ * Bounded multi-producer multi-consumer queue over the same ring layout as
+ * the static Queue, for handing records between pipeline stages.
+ *
+ * push() blocks while the queue is full and pop() while it is empty.
+ * push_batch() and pop_batch() transfer as many items as fit per lock
+ * acquisition. After close(), pushes fail and pops drain what is left and
+ * then fail. statistics() reports how long callers were blocked, which is
+ * the backpressure signal between stages.
+ */
+template <typename Tp>
+class BlockingQueue {
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+  typedef std::chrono::steady_clock clock_type;
+
+  struct Statistics {
+    Statistics() : full_waits(0), empty_waits(0),
+                   blocked_on_full(0), blocked_on_empty(0) {}
+    size_type full_waits;
+    size_type empty_waits;
+    std::chrono::nanoseconds blocked_on_full;
+    std::chrono::nanoseconds blocked_on_empty;
+  };
+
+  explicit BlockingQueue(size_type capacity = 64) :
+    capacity_(capacity), size_(0), front_index_(0),
+    back_index_(capacity - 1), closed_(false), waiting_producers_(0),
+    waiting_consumers_(0), container_(capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("BlockingQueue capacity must be positive.");
+    }
+  }
+  BlockingQueue(const BlockingQueue&) = delete;
+  BlockingQueue& operator=(const BlockingQueue&) = delete;
+  virtual ~BlockingQueue() {}
+
+  bool empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_ == 0;
+  }
+  bool full() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_ >= capacity_;
+  }
+  size_type size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+  size_type capacity() const { return capacity_; }
+  bool closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+  }
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+  Statistics statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+  // Each push returns false if the queue is (or becomes) closed before the
+  // value could be stored.
+  bool push(const value_type& value) {
+    return push_until(value, clock_type::time_point::max());
+  }
+  bool push(value_type&& value) {
+    return push_until(std::move(value), clock_type::time_point::max());
+  }
+  bool try_push(const value_type& value) {
+    return push_until(value, clock_type::time_point::min());
+  }
+  bool try_push(value_type&& value) {
+    return push_until(std::move(value), clock_type::time_point::min());
+  }
+  template <typename Rep, typename Period>
+  bool push_for(const value_type& value,
+                const std::chrono::duration<Rep, Period>& timeout) {
+    return push_until(value, deadline(timeout));
+  }
+  template <typename Rep, typename Period>
+  bool push_for(value_type&& value,
+                const std::chrono::duration<Rep, Period>& timeout) {
+    return push_until(std::move(value), deadline(timeout));
+  }
+
+  // Each pop returns false if nothing could be taken: the queue stayed
+  // empty until the deadline, or it is closed and drained.
+  bool pop(value_type& value) {
+    return pop_batch_until(&value, 1, clock_type::time_point::max()) == 1;
+  }
+  bool try_pop(value_type& value) {
+    return pop_batch_until(&value, 1, clock_type::time_point::min()) == 1;
+  }
+  template <typename Rep, typename Period>
+  bool pop_for(value_type& value,
+               const std::chrono::duration<Rep, Period>& timeout) {
+    return pop_batch_until(&value, 1, deadline(timeout)) == 1;
+  }
+
+  // Stores [first, last) in order, blocking for space as needed, and
+  // returns the number stored, which is short only if the queue is closed
+  // or, for push_batch_for, the timeout passes while the queue is full.
+  // Pass std::make_move_iterator() iterators to move the items in.
+  template <typename InputIterator>
+  size_type push_batch(InputIterator first, InputIterator last) {
+    return push_batch_until(first, last, clock_type::time_point::max());
+  }
+  template <typename InputIterator, typename Rep, typename Period>
+  size_type push_batch_for(InputIterator first, InputIterator last,
+                           const std::chrono::duration<Rep, Period>& timeout) {
+    return push_batch_until(first, last, deadline(timeout));
+  }
+  // Takes up to max_items, blocking only until at least one is available,
+  // and returns the number taken (zero once closed and drained).
+  template <typename OutputIterator>
+  size_type pop_batch(OutputIterator out, size_type max_items) {
+    return pop_batch_until(out, max_items, clock_type::time_point::max());
+  }
+  template <typename OutputIterator, typename Rep, typename Period>
+  size_type pop_batch_for(OutputIterator out, size_type max_items,
+                          const std::chrono::duration<Rep, Period>& timeout) {
+    return pop_batch_until(out, max_items, deadline(timeout));
+  }
+
+protected:
+  template <typename Rep, typename Period>
+  static clock_type::time_point deadline(
+    const std::chrono::duration<Rep, Period>& timeout) {
+    return clock_type::now() +
+           std::chrono::duration_cast<clock_type::duration>(timeout);
+  }
+
+  template <typename Value>
+  bool push_until(Value&& value, clock_type::time_point until) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!wait_not_full(lock, until)) {
+      return false;
+    }
+    store(std::forward<Value>(value));
+    notify_consumers(1);
+    return true;
+  }
+  template <typename InputIterator>
+  size_type push_batch_until(InputIterator first, InputIterator last,
+                             clock_type::time_point until) {
+    size_type pushed = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (first != last) {
+      if (!wait_not_full(lock, until)) {
+        break;
+      }
+      size_type batch = 0;
+      while (first != last && size_ < capacity_) {
+        store(*first);
+        ++first;
+        ++batch;
+      }
+      pushed += batch;
+      notify_consumers(batch);
+    }
+    return pushed;
+  }
+  template <typename OutputIterator>
+  size_type pop_batch_until(OutputIterator out, size_type max_items,
+                            clock_type::time_point until) {
+    if (max_items == 0) {
+      return 0;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!wait_not_empty(lock, until)) {
+      return 0;
+    }
+    size_type popped = 0;
+    while (popped < max_items && size_ > 0) {
+      *out = std::move(container_[front_index_]);
+      ++out;
+      front_index_ = front_index_ + 1 == capacity_ ? 0 : front_index_ + 1;
+      --size_;
+      ++popped;
+    }
+    if (waiting_producers_ > 0) {
+      lock.unlock();
+      if (popped > 1) {
+        not_full_.notify_all();
+      } else {
+        not_full_.notify_one();
+      }
+    }
+    return popped;
+  }
+
+  // Both waits return false if the deadline passes or, for producers, the
+  // queue is closed; a closed queue still lets consumers drain it.
+  bool wait_not_full(std::unique_lock<std::mutex>& lock,
+                     clock_type::time_point until) {
+    if (closed_) {
+      return false;
+    }
+    if (size_ < capacity_) {
+      return true;
+    }
+    if (until == clock_type::time_point::min()) {
+      return false;
+    }
+    clock_type::time_point start = clock_type::now();
+    ++waiting_producers_;
+    ++statistics_.full_waits;
+    bool ready = wait(not_full_, lock, until, [this]() {
+      return closed_ || size_ < capacity_;
+    });
+    --waiting_producers_;
+    statistics_.blocked_on_full += clock_type::now() - start;
+    return ready && !closed_;
+  }
+  bool wait_not_empty(std::unique_lock<std::mutex>& lock,
+                      clock_type::time_point until) {
+    if (size_ > 0) {
+      return true;
+    }
+    if (closed_ || until == clock_type::time_point::min()) {
+      return false;
+    }
+    clock_type::time_point start = clock_type::now();
+    ++waiting_consumers_;
+    ++statistics_.empty_waits;
+    bool ready = wait(not_empty_, lock, until, [this]() {
+      return closed_ || size_ > 0;
+    });
+    --waiting_consumers_;
+    statistics_.blocked_on_empty += clock_type::now() - start;
+    return ready && size_ > 0;
+  }
+  template <typename Predicate>
+  static bool wait(std::condition_variable& condition,
+                   std::unique_lock<std::mutex>& lock,
+                   clock_type::time_point until, Predicate ready) {
+    if (until == clock_type::time_point::max()) {
+      condition.wait(lock, ready);
+      return true;
+    }
+    return condition.wait_until(lock, until, ready);
+  }
+  template <typename Value>
+  void store(Value&& value) {
+    size_type index = back_index_ + 1 == capacity_ ? 0 : back_index_ + 1;
+    container_[index] = std::forward<Value>(value);
+    back_index_ = index;
+    ++size_;
+  }
+  void notify_consumers(size_type count) {
+    if (waiting_consumers_ == 0 || count == 0) {
+      return;
+    }
+    if (count > 1) {
+      not_empty_.notify_all();
+    } else {
+      not_empty_.notify_one();
+    }
+  }
+
+  const size_type capacity_;
+  size_type size_;
+  size_type front_index_;
+  size_type back_index_;
+  bool closed_;
+  size_type waiting_producers_;
+  size_type waiting_consumers_;
+  Statistics statistics_;
+  std::vector<Tp> container_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+#endif  // BLOCKING_QUEUE_H_
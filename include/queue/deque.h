@@ -0,0 +1,271 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef DEQUE_H_
+#define DEQUE_H_
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Double-ended queue made of fixed-size blocks addressed through a
+ * central block map. Elements sit at consecutive positions across the
+ * mapped blocks, so indexing is one division away, and the map is only
+ * reallocated (or recentred) when one end runs out of slots. Blocks that
+ * become empty are kept for reuse until shrink_to_fit().
+ */
+template <typename Tp, std::size_t block_size =
+          (sizeof(Tp) < 256 ? 4096 / sizeof(Tp) : 16)>
+class Deque {
+  static_assert(block_size > 0, "block_size must be positive.");
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+
+  Deque() : size_(0), start_(0) {}
+  Deque(const Deque& other) : size_(0), start_(0) {
+    for (size_type i = 0; i < other.size_; ++i) {
+      push_back(other[i]);
+    }
+  }
+  Deque(Deque&& other) : size_(0), start_(0) {
+    swap(other);
+  }
+  Deque& operator=(const Deque& rhs) {
+    Deque copy(rhs);
+    swap(copy);
+    return *this;
+  }
+  Deque& operator=(Deque&& rhs) {
+    swap(rhs);
+    return *this;
+  }
+  virtual ~Deque() {
+    clear();
+    shrink_to_fit();
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  void clear() {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+  void shrink_to_fit() {
+    for (Block* block : spare_blocks_) {
+      delete block;
+    }
+    spare_blocks_.clear();
+  }
+  void swap(Deque& other) {
+    std::swap(size_, other.size_);
+    std::swap(start_, other.start_);
+    map_.swap(other.map_);
+    spare_blocks_.swap(other.spare_blocks_);
+  }
+
+  reference operator[](size_type index) { return *slot(start_ + index); }
+  const_reference operator[](size_type index) const {
+    return *slot(start_ + index);
+  }
+  reference at(size_type index) {
+    check_range(index);
+    return (*this)[index];
+  }
+  const_reference at(size_type index) const {
+    check_range(index);
+    return (*this)[index];
+  }
+  reference front() {
+    require_nonempty("Deque::front()");
+    return (*this)[0];
+  }
+  const_reference front() const {
+    require_nonempty("Deque::front()");
+    return (*this)[0];
+  }
+  reference back() {
+    require_nonempty("Deque::back()");
+    return (*this)[size_ - 1];
+  }
+  const_reference back() const {
+    require_nonempty("Deque::back()");
+    return (*this)[size_ - 1];
+  }
+
+  void push_back(const value_type& value) { emplace_back(value); }
+  void push_back(value_type&& value) { emplace_back(std::move(value)); }
+  void push_front(const value_type& value) { emplace_front(value); }
+  void push_front(value_type&& value) { emplace_front(std::move(value)); }
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (start_ + size_ == map_.size() * block_size) {
+      make_room();
+    }
+    size_type position = start_ + size_;
+    Tp* target = construct(position, position % block_size == 0,
+                           std::forward<Args>(args)...);
+    ++size_;
+    return *target;
+  }
+  template <typename... Args>
+  reference emplace_front(Args&&... args) {
+    if (start_ == 0) {
+      make_room();
+    }
+    size_type position = start_ - 1;
+    Tp* target = construct(position,
+                           position % block_size == block_size - 1,
+                           std::forward<Args>(args)...);
+    start_ = position;
+    ++size_;
+    return *target;
+  }
+  void pop_back() {
+    require_nonempty("Deque::pop_back()");
+    size_type position = start_ + size_ - 1;
+    slot(position)->~Tp();
+    --size_;
+    if (position % block_size == 0) {
+      recycle_block(position / block_size);
+    }
+    if (size_ == 0) {
+      reset_empty();
+    }
+  }
+  void pop_front() {
+    require_nonempty("Deque::pop_front()");
+    slot(start_)->~Tp();
+    ++start_;
+    --size_;
+    if (start_ % block_size == 0) {
+      recycle_block(start_ / block_size - 1);
+    }
+    if (size_ == 0) {
+      reset_empty();
+    }
+  }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for (size_type i = 0; i < size_; ++i) {
+      func((*this)[i]);
+    }
+  }
+
+protected:
+  struct Block {
+    typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type
+      data[block_size];
+  };
+
+  Tp* slot(size_type position) const {
+    return reinterpret_cast<Tp*>(
+      &map_[position / block_size]->data[position % block_size]);
+  }
+  // first_in_block: the element is the first one placed in its block, so
+  // the block is handed back if construction throws.
+  template <typename... Args>
+  Tp* construct(size_type position, bool first_in_block, Args&&... args) {
+    Block*& block = map_[position / block_size];
+    if (block == nullptr) {
+      if (spare_blocks_.empty()) {
+        block = new Block();
+      } else {
+        block = spare_blocks_.back();
+        spare_blocks_.pop_back();
+      }
+    }
+    Tp* target = slot(position);
+    try {
+      ::new (static_cast<void*>(target)) Tp(std::forward<Args>(args)...);
+    } catch (...) {
+      if (first_in_block) {
+        recycle_block(position / block_size);
+      }
+      throw;
+    }
+    return target;
+  }
+  void recycle_block(size_type block_index) {
+    spare_blocks_.push_back(map_[block_index]);
+    map_[block_index] = nullptr;
+  }
+  void reset_empty() {
+    if (start_ % block_size != 0) {
+      recycle_block(start_ / block_size);
+    }
+    start_ = map_.size() / 2 * block_size;
+  }
+  // Makes free slots at both ends, either by moving the used blocks to the
+  // middle of the map or by doubling the map.
+  void make_room() {
+    size_type first_block = start_ / block_size;
+    size_type used_blocks = size_ == 0 ?
+      0 : (start_ + size_ - 1) / block_size - first_block + 1;
+    size_type new_map_size = map_.size();
+    if (new_map_size == 0) {
+      new_map_size = 8;
+    } else if (2 * (used_blocks + 1) > new_map_size) {
+      new_map_size *= 2;
+    }
+    size_type new_first_block = (new_map_size - used_blocks) / 2;
+    std::vector<Block*> new_map(new_map_size, nullptr);
+    for (size_type i = 0; i < used_blocks; ++i) {
+      new_map[new_first_block + i] = map_[first_block + i];
+    }
+    map_.swap(new_map);
+    start_ = new_first_block * block_size + start_ % block_size;
+    if (size_ == 0) {
+      start_ = map_.size() / 2 * block_size;
+    }
+  }
+  void check_range(size_type index) const {
+    if (index >= size_) {
+      throw std::out_of_range(
+        "Deque range check failed: " +
+        std::to_string(index) + " is out of the range [0, " +
+        std::to_string(size_) + ").");
+    }
+  }
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the deque is empty.");
+    }
+  }
+
+  size_type size_;
+  size_type start_;
+  std::vector<Block*> map_;
+  std::vector<Block*> spare_blocks_;
+};
+
+#endif  // DEQUE_H_
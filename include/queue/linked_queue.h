@@ -26,52 +26,71 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
-template <typename Tp>
+#include "memory/node_pool.h"
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
 class Queue {
 public:
   typedef Tp value_type;
   typedef Tp& reference;
   typedef const Tp& const_reference;
   typedef std::size_t size_type;
+  typedef Alloc allocator_type;
 
   Queue() : size_(0), front_ptr_(nullptr), back_ptr_(nullptr) {}
+  explicit Queue(const Alloc& alloc) :
+    size_(0), front_ptr_(nullptr), back_ptr_(nullptr),
+    pool_(NodeAllocator(alloc)) {}
   Queue(const Queue& other) : 
-    size_(other.size_), front_ptr_(nullptr), back_ptr_(nullptr) {
+    size_(other.size_), front_ptr_(nullptr), back_ptr_(nullptr),
+    pool_(std::allocator_traits<NodeAllocator>::
+          select_on_container_copy_construction(other.pool_.get_allocator())) {
     if (!other.empty()) {
       deep_copy(front_ptr_, back_ptr_, other);
     }
   }
-  Queue(Queue&& other) : 
-    size_(std::move(other.size_)), front_ptr_(std::move(other.front_ptr_)),
-    back_ptr_(std::move(other.back_ptr_)) {}
-  Queue& operator=(const Queue& rhs) {
-    size_type new_size = rhs.size_;
-    NodePtr new_front_ptr = nullptr, new_back_ptr = nullptr;
-    if (!rhs.empty()) {
-      deep_copy(new_front_ptr, new_back_ptr, rhs);
+  Queue(const Queue& other, const Alloc& alloc) :
+    size_(other.size_), front_ptr_(nullptr), back_ptr_(nullptr),
+    pool_(NodeAllocator(alloc)) {
+    if (!other.empty()) {
+      deep_copy(front_ptr_, back_ptr_, other);
     }
-    clear();
-    size_ = new_size;
-    front_ptr_ = new_front_ptr;
-    back_ptr_ = new_back_ptr;
+  }
+  Queue(Queue&& other) : size_(0), front_ptr_(nullptr), back_ptr_(nullptr) {
+    swap(other);
+  }
+  // Copy assignment keeps this queue's allocator; move assignment and
+  // swap exchange allocators along with the nodes.
+  Queue& operator=(const Queue& rhs) {
+    Queue copy(rhs, get_allocator());
+    swap(copy);
     return *this;
   }
   Queue& operator=(Queue&& rhs) {
-    size_ = std::move(rhs.size_);
-    front_ptr_ = std::move(rhs.front_ptr_);
-    back_ptr_ = std::move(rhs.back_ptr_);
+    swap(rhs);
     return *this;
   }
-  virtual ~Queue() {}
+  virtual ~Queue() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const {
+    return allocator_type(pool_.get_allocator());
+  }
   void clear() {
+    pool_.destroy_all(front_ptr_, &Node::next);
     size_ = 0;
     front_ptr_ = nullptr;
     back_ptr_ = nullptr;
   }
+  void swap(Queue& other) {
+    std::swap(size_, other.size_);
+    std::swap(front_ptr_, other.front_ptr_);
+    std::swap(back_ptr_, other.back_ptr_);
+    pool_.swap(other.pool_);
+  }
 
   reference front() {
     require_nonempty("Queue::front()");
@@ -91,7 +110,7 @@ public:
   }
 
   void push(const value_type& value) {
-    NodePtr new_back_ptr = std::make_shared<Node>(value);
+    NodePtr new_back_ptr = pool_.create(value);
     if (size_ == 0) {
       front_ptr_ = back_ptr_ = new_back_ptr;
     } else {
@@ -102,7 +121,9 @@ public:
   }
   void pop() {
     require_nonempty("Queue::pop()");
+    NodePtr old_front_ptr = front_ptr_;
     front_ptr_ = front_ptr_->next;
+    pool_.destroy(old_front_ptr);
     if (size_ == 1) {
       back_ptr_ = nullptr;
     }
@@ -111,7 +132,7 @@ public:
 
 protected:
   struct Node;
-  typedef std::shared_ptr<Node> NodePtr;
+  typedef Node* NodePtr;
   struct Node {
     Node() : value(Tp()), next(nullptr) {}
     explicit Node(const Tp& x) : value(x), next(nullptr) {}
@@ -119,19 +140,21 @@ protected:
     Tp value;
     NodePtr next;
   };
+  typedef typename std::allocator_traits<Alloc>::template
+    rebind_alloc<Node> NodeAllocator;
 
   void deep_copy(NodePtr& new_front_ptr, NodePtr& new_back_ptr, 
                  const Queue& other) {
-    new_front_ptr = std::make_shared<Node>(other.front_ptr_->value);
+    new_front_ptr = pool_.create(other.front_ptr_->value);
     NodePtr copy_ptr = new_front_ptr, other_ptr = other.front_ptr_;
     while (other_ptr->next != nullptr) {
       other_ptr = other_ptr->next;
-      copy_ptr->next = std::make_shared<Node>(other_ptr->value);
+      copy_ptr->next = pool_.create(other_ptr->value);
       copy_ptr = copy_ptr->next;
     }
     new_back_ptr = copy_ptr;
   }
-  void require_nonempty(const std::string& function_name) {
+  void require_nonempty(const std::string& function_name) const {
     if (empty()) {
       throw std::out_of_range(
         function_name + " is undefined when the queue is empty.");
@@ -141,6 +164,7 @@ protected:
   size_type size_;
   NodePtr front_ptr_;
   NodePtr back_ptr_;
+  NodePool<Node, NodeAllocator> pool_;
 };
 
 #endif  // QUEUE_H_
\ No newline at end of file
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef SEGMENTED_QUEUE_H_
+#define SEGMENTED_QUEUE_H_
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Unbounded FIFO queue built from fixed-size segments linked together.
+ * Elements of a segment are contiguous, and segments drained by pop() are
+ * kept on a free list and reused by push(), so a queue in steady state
+ * does not touch the allocator.
+ */
+template <typename Tp, std::size_t segment_size = 512>
+class SegmentedQueue {
+  static_assert(segment_size > 0, "segment_size must be positive.");
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+
+  SegmentedQueue() :
+    size_(0), front_index_(0), back_index_(0), front_segment_(nullptr),
+    back_segment_(nullptr), free_segments_(nullptr) {}
+  SegmentedQueue(const SegmentedQueue& other) : SegmentedQueue() {
+    other.traverse([this](const value_type& value) { push(value); });
+  }
+  SegmentedQueue(SegmentedQueue&& other) : SegmentedQueue() {
+    swap(other);
+  }
+  SegmentedQueue& operator=(const SegmentedQueue& rhs) {
+    SegmentedQueue copy(rhs);
+    swap(copy);
+    return *this;
+  }
+  SegmentedQueue& operator=(SegmentedQueue&& rhs) {
+    swap(rhs);
+    return *this;
+  }
+  virtual ~SegmentedQueue() {
+    clear();
+    shrink_to_fit();
+    release_segment(front_segment_);
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  void clear() {
+    while (!empty()) {
+      pop();
+    }
+  }
+  // Returns the segments held on the free list to the allocator.
+  void shrink_to_fit() {
+    while (free_segments_ != nullptr) {
+      Segment* next = free_segments_->next;
+      delete free_segments_;
+      free_segments_ = next;
+    }
+  }
+  void swap(SegmentedQueue& other) {
+    std::swap(size_, other.size_);
+    std::swap(front_index_, other.front_index_);
+    std::swap(back_index_, other.back_index_);
+    std::swap(front_segment_, other.front_segment_);
+    std::swap(back_segment_, other.back_segment_);
+    std::swap(free_segments_, other.free_segments_);
+  }
+
+  reference front() {
+    require_nonempty("SegmentedQueue::front()");
+    return *front_segment_->at(front_index_);
+  }
+  const_reference front() const {
+    require_nonempty("SegmentedQueue::front()");
+    return *front_segment_->at(front_index_);
+  }
+  reference back() {
+    require_nonempty("SegmentedQueue::back()");
+    return *back_segment_->at(back_index_ - 1);
+  }
+  const_reference back() const {
+    require_nonempty("SegmentedQueue::back()");
+    return *back_segment_->at(back_index_ - 1);
+  }
+
+  void push(const value_type& value) { emplace(value); }
+  void push(value_type&& value) { emplace(std::move(value)); }
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    if (back_segment_ == nullptr) {
+      Segment* segment = acquire_segment();
+      construct(segment, 0, std::forward<Args>(args)...);
+      front_segment_ = back_segment_ = segment;
+      front_index_ = 0;
+      back_index_ = 1;
+    } else if (back_index_ == segment_size) {
+      Segment* segment = acquire_segment();
+      construct(segment, 0, std::forward<Args>(args)...);
+      back_segment_->next = segment;
+      back_segment_ = segment;
+      back_index_ = 1;
+    } else {
+      construct(back_segment_, back_index_, std::forward<Args>(args)...);
+      ++back_index_;
+    }
+    ++size_;
+  }
+  void pop() {
+    require_nonempty("SegmentedQueue::pop()");
+    front_segment_->at(front_index_)->~Tp();
+    ++front_index_;
+    --size_;
+    if (size_ == 0) {
+      // Keep the last segment in place so that a queue oscillating around
+      // empty keeps reusing it.
+      front_index_ = 0;
+      back_index_ = 0;
+    } else if (front_index_ == segment_size) {
+      Segment* drained = front_segment_;
+      front_segment_ = front_segment_->next;
+      front_index_ = 0;
+      recycle_segment(drained);
+    }
+  }
+
+  template <typename Function>
+  void traverse(Function func) {
+    for_each_element(front_segment_, func);
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for_each_element(static_cast<const Segment*>(front_segment_), func);
+  }
+
+protected:
+  struct Segment {
+    Segment() : next(nullptr) {}
+    Tp* at(size_type index) {
+      return reinterpret_cast<Tp*>(&data[index]);
+    }
+    const Tp* at(size_type index) const {
+      return reinterpret_cast<const Tp*>(&data[index]);
+    }
+    typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type
+      data[segment_size];
+    Segment* next;
+  };
+
+  template <typename... Args>
+  void construct(Segment* segment, size_type index, Args&&... args) {
+    try {
+      ::new (static_cast<void*>(segment->at(index)))
+        Tp(std::forward<Args>(args)...);
+    } catch (...) {
+      if (segment != back_segment_) {
+        recycle_segment(segment);
+      }
+      throw;
+    }
+  }
+  Segment* acquire_segment() {
+    if (free_segments_ == nullptr) {
+      return new Segment();
+    }
+    Segment* segment = free_segments_;
+    free_segments_ = segment->next;
+    segment->next = nullptr;
+    return segment;
+  }
+  void recycle_segment(Segment* segment) {
+    segment->next = free_segments_;
+    free_segments_ = segment;
+  }
+  void release_segment(Segment* segment) {
+    delete segment;
+  }
+  template <typename SegmentPtr, typename Function>
+  void for_each_element(SegmentPtr segment, Function& func) const {
+    size_type index = front_index_, remaining = size_;
+    while (remaining > 0) {
+      size_type end = index + remaining < segment_size ?
+                      index + remaining : segment_size;
+      for (size_type i = index; i < end; ++i) {
+        func(*segment->at(i));
+      }
+      remaining -= end - index;
+      segment = segment->next;
+      index = 0;
+    }
+  }
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the queue is empty.");
+    }
+  }
+
+  size_type size_;
+  size_type front_index_;
+  size_type back_index_;
+  Segment* front_segment_;
+  Segment* back_segment_;
+  Segment* free_segments_;
+};
+
+#endif  // SEGMENTED_QUEUE_H_
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef WORK_STEALING_DEQUE_H_
+#define WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Chase-Lev work-stealing deque with a growable circular array, using the
+ * memory orderings of Le et al., "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (PPoPP 2013).
+ *
+ * Only the owning thread may call push() and pop(), which work at the
+ * bottom end. Any thread may call steal(), which takes from the top end.
+ * Arrays outgrown by push() are retired rather than freed, since a thief
+ * may still be reading them; they are released with the deque.
+ */
+template <typename Tp>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable<Tp>::value,
+                "WorkStealingDeque requires a trivially copyable type.");
+
+public:
+  typedef Tp value_type;
+  typedef std::size_t size_type;
+
+  explicit WorkStealingDeque(size_type capacity = 256) :
+    top_(0), bottom_(0), array_(new Array(round_up_capacity(capacity))) {}
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  virtual ~WorkStealingDeque() {
+    delete array_.load(std::memory_order_relaxed);
+  }
+
+  bool empty() const { return size() == 0; }
+  size_type size() const {
+    std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    std::int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+  }
+  size_type capacity() const {
+    return array_.load(std::memory_order_relaxed)->capacity;
+  }
+
+  void push(const value_type& value) {
+    std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    std::int64_t top = top_.load(std::memory_order_acquire);
+    Array* array = array_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<std::int64_t>(array->capacity) - 1) {
+      array = grow(array, bottom, top);
+    }
+    array->put(bottom, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  bool pop(value_type& value) {
+    std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* array = array_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = array->get(bottom);
+    if (top == bottom) {
+      // Last element: race against the thieves for it.
+      bool won = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+  // Returns false if the deque was empty or another thread won the race.
+  bool steal(value_type& value) {
+    std::int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return false;
+    }
+    Array* array = array_.load(std::memory_order_acquire);
+    value_type stolen = array->get(top);
+    if (!top_.compare_exchange_strong(
+          top, top + 1, std::memory_order_seq_cst,
+          std::memory_order_relaxed)) {
+      return false;
+    }
+    value = stolen;
+    return true;
+  }
+
+protected:
+  struct Array {
+    explicit Array(size_type n) :
+      capacity(n), mask(n - 1), buffer(new std::atomic<Tp>[n]) {}
+    Tp get(std::int64_t index) const {
+      return buffer[static_cast<size_type>(index) & mask].load(
+        std::memory_order_relaxed);
+    }
+    void put(std::int64_t index, const Tp& value) {
+      buffer[static_cast<size_type>(index) & mask].store(
+        value, std::memory_order_relaxed);
+    }
+    size_type capacity;
+    size_type mask;
+    std::unique_ptr<std::atomic<Tp>[]> buffer;
+  };
+
+  static size_type round_up_capacity(size_type capacity) {
+    size_type rounded = 2;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+  Array* grow(Array* array, std::int64_t bottom, std::int64_t top) {
+    Array* bigger = new Array(array->capacity * 2);
+    for (std::int64_t i = top; i < bottom; ++i) {
+      bigger->put(i, array->get(i));
+    }
+    retired_.emplace_back(array);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  std::atomic<std::int64_t> top_;
+  std::atomic<std::int64_t> bottom_;
+  std::atomic<Array*> array_;
+  std::vector<std::unique_ptr<Array>> retired_;
+};
+
+#endif  // WORK_STEALING_DEQUE_H_
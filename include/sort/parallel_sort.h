@@ -0,0 +1,73 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef PARALLEL_SORT_H_
+#define PARALLEL_SORT_H_
+
+#include <iterator>
+
+#include "parallel/fork_join_pool.h"
+#include "sort/sort.h"
+
+
+namespace detail {
+
+template <typename Iterator>
+void parallel_quick_sort(
+  Iterator iter_begin, Iterator iter_end, ForkJoinPool& pool,
+  typename std::iterator_traits<Iterator>::difference_type grain_size) {
+  if (iter_end - iter_begin <= grain_size) {
+    quick_sort(iter_begin, iter_end);
+    return;
+  }
+  swap(*iter_begin, *(iter_begin + (iter_end - iter_begin) / 2));
+  Iterator iter_pivot = iter_begin;
+  for (Iterator it = iter_begin + 1; it != iter_end; ++it) {
+    if (*it < *iter_begin) {
+      ++iter_pivot;
+      swap(*iter_pivot, *it);
+    }
+  }
+  swap(*iter_begin, *iter_pivot);
+  pool.fork_join(
+    [&]() {
+      detail::parallel_quick_sort(iter_begin, iter_pivot, pool, grain_size);
+    },
+    [&]() {
+      detail::parallel_quick_sort(iter_pivot + 1, iter_end, pool, grain_size);
+    });
+}
+
+}  // namespace detail
+
+
+// Ranges shorter than grain_size are sorted sequentially by quick_sort.
+template <typename Iterator>
+void parallel_quick_sort(
+  Iterator iter_begin, Iterator iter_end, ForkJoinPool& pool,
+  typename std::iterator_traits<Iterator>::difference_type grain_size = 4096) {
+  if (iter_begin >= iter_end) return;
+  pool.invoke([&]() {
+    detail::parallel_quick_sort(iter_begin, iter_end, pool, grain_size);
+  });
+}
+
+#endif  // PARALLEL_SORT_H_
@@ -26,48 +26,68 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
+#include "memory/node_pool.h"
 
-template <typename Tp>
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
 class Stack {
 public:
   typedef Tp value_type;
   typedef Tp& reference;
   typedef const Tp& const_reference;
   typedef std::size_t size_type;
+  typedef Alloc allocator_type;
 
   Stack() : size_(0), top_ptr_(nullptr) {}
-  Stack(const Stack& other) : size_(other.size_), top_ptr_(nullptr) {
+  explicit Stack(const Alloc& alloc) :
+    size_(0), top_ptr_(nullptr), pool_(NodeAllocator(alloc)) {}
+  Stack(const Stack& other) :
+    size_(other.size_), top_ptr_(nullptr),
+    pool_(std::allocator_traits<NodeAllocator>::
+          select_on_container_copy_construction(other.pool_.get_allocator())) {
     if (!other.empty()) {
       deep_copy(top_ptr_, other);
     }
   }
-  Stack(Stack&& other) : 
-    size_(std::move(other.size_)), top_ptr_(std::move(other.top_ptr_)) {}
-  Stack& operator=(const Stack& rhs) {
-    size_type new_size = rhs.size_;
-    NodePtr new_top_ptr = nullptr;
-    if (!rhs.empty()) {
-      deep_copy(new_top_ptr, rhs);
+  Stack(const Stack& other, const Alloc& alloc) :
+    size_(other.size_), top_ptr_(nullptr), pool_(NodeAllocator(alloc)) {
+    if (!other.empty()) {
+      deep_copy(top_ptr_, other);
     }
-    clear();
-    size_ = new_size; 
-    top_ptr_ = new_top_ptr;
+  }
+  Stack(Stack&& other) : size_(0), top_ptr_(nullptr) {
+    swap(other);
+  }
+  // Copy assignment keeps this stack's allocator; move assignment and
+  // swap exchange allocators along with the nodes.
+  Stack& operator=(const Stack& rhs) {
+    Stack copy(rhs, get_allocator());
+    swap(copy);
     return *this;
   }
   Stack& operator=(Stack&& rhs) {
-    size_ = std::move(rhs.size_);
-    top_ptr_ = std::move(rhs.top_ptr_);
+    swap(rhs);
     return *this;
   }
-  virtual ~Stack() {}
+  virtual ~Stack() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const {
+    return allocator_type(pool_.get_allocator());
+  }
   void clear() {
+    pool_.destroy_all(top_ptr_, &Node::next);
     size_ = 0;
     top_ptr_ = nullptr;
   }
+  void swap(Stack& other) {
+    std::swap(size_, other.size_);
+    std::swap(top_ptr_, other.top_ptr_);
+    pool_.swap(other.pool_);
+  }
 
   reference top() {
     require_nonempty("Stack::top()");
@@ -79,20 +99,22 @@ public:
   }
 
   void push(const value_type& value) {
-    NodePtr new_top_ptr = std::make_shared<Node>(value);
+    NodePtr new_top_ptr = pool_.create(value);
     new_top_ptr->next = top_ptr_;
     top_ptr_ = new_top_ptr;
     ++size_;
   }
   void pop() {
     require_nonempty("Stack::pop()");
+    NodePtr old_top_ptr = top_ptr_;
     top_ptr_ = top_ptr_->next;
+    pool_.destroy(old_top_ptr);
     --size_;
   }
 
 protected:
   struct Node;
-  typedef std::shared_ptr<Node> NodePtr;
+  typedef Node* NodePtr;
   struct Node {
     Node() : value(Tp()), next(nullptr) {}
     explicit Node(const Tp& x) : value(x), next(nullptr) {}
@@ -100,17 +122,19 @@ protected:
     Tp value;
     NodePtr next;
   };
+  typedef typename std::allocator_traits<Alloc>::template
+    rebind_alloc<Node> NodeAllocator;
 
   void deep_copy(NodePtr& new_top_ptr, const Stack& other) {
-    new_top_ptr = std::make_shared<Node>(other.top_ptr_->value);
+    new_top_ptr = pool_.create(other.top_ptr_->value);
     NodePtr copy_ptr = new_top_ptr, other_ptr = other.top_ptr_;
     while (other_ptr->next != nullptr) {
       other_ptr = other_ptr->next;
-      copy_ptr->next = std::make_shared<Node>(other_ptr->value);
+      copy_ptr->next = pool_.create(other_ptr->value);
       copy_ptr = copy_ptr->next;
     }
   }
-  void require_nonempty(const std::string& function_name) {
+  void require_nonempty(const std::string& function_name) const {
     if (empty()) {
       throw std::out_of_range(
         function_name + " is undefined when the stack is empty.");
@@ -119,6 +143,7 @@ protected:
 
   size_type size_;
   NodePtr top_ptr_;
+  NodePool<Node, NodeAllocator> pool_;
 };
 
 #endif  // STACK_H_
\ No newline at end of file
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef LOCK_FREE_STACK_H_
+#define LOCK_FREE_STACK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Lock-free Treiber stack that is safe to share between threads.
+ *
+ * Nodes live in an internal pool of chunks that are only freed with the
+ * stack, and are addressed by 32-bit indices. The stack top and the pool
+ * free list are each a single 64-bit word holding an index and a version
+ * tag bumped by every successful update, which rules out ABA. Popped nodes
+ * go back to the pool, so steady-state push/pop never allocate.
+ */
+template <typename Tp>
+class LockFreeStack {
+public:
+  typedef Tp value_type;
+  typedef std::size_t size_type;
+
+  LockFreeStack() : top_(pack(null_index, 0)), free_(pack(null_index, 0)),
+                    num_chunks_(0) {
+    for (size_type i = 0; i < max_chunks; ++i) {
+      chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  LockFreeStack(const LockFreeStack&) = delete;
+  LockFreeStack& operator=(const LockFreeStack&) = delete;
+  virtual ~LockFreeStack() {
+    std::uint32_t index = unpack_index(top_.load(std::memory_order_acquire));
+    while (index != null_index) {
+      Node& node = to_node(index);
+      node.value()->~Tp();
+      index = node.next.load(std::memory_order_relaxed);
+    }
+    for (size_type i = 0; i < num_chunks_; ++i) {
+      delete[] chunks_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  // Only a snapshot when other threads are pushing or popping.
+  bool empty() const {
+    return unpack_index(top_.load(std::memory_order_acquire)) == null_index;
+  }
+  // Grows the node pool so that n more pushes need no allocation. Meant
+  // to be called before the stack is shared.
+  void reserve(size_type n) {
+    std::lock_guard<std::mutex> lock(grow_mutex_);
+    while (count_free() < n) {
+      add_chunk();
+    }
+  }
+
+  void push(const value_type& value) { emplace(value); }
+  void push(value_type&& value) { emplace(std::move(value)); }
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    std::uint32_t index = acquire_node();
+    Node& node = to_node(index);
+    try {
+      ::new (node.storage()) Tp(std::forward<Args>(args)...);
+    } catch (...) {
+      push_index(free_, index);
+      throw;
+    }
+    push_index(top_, index);
+  }
+  bool pop(value_type& value) {
+    std::uint32_t index = pop_index(top_);
+    if (index == null_index) {
+      return false;
+    }
+    Node& node = to_node(index);
+    value = std::move(*node.value());
+    node.value()->~Tp();
+    push_index(free_, index);
+    return true;
+  }
+
+protected:
+  static constexpr std::uint32_t null_index = 0xffffffffu;
+  static constexpr size_type first_chunk_size = 64;
+  static constexpr size_type max_chunks = 26;
+
+  struct Node {
+    void* storage() { return static_cast<void*>(&data); }
+    Tp* value() { return reinterpret_cast<Tp*>(&data); }
+    typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type data;
+    std::atomic<std::uint32_t> next;
+  };
+
+  static std::uint64_t pack(std::uint32_t index, std::uint32_t tag) {
+    return (static_cast<std::uint64_t>(tag) << 32) | index;
+  }
+  static std::uint32_t unpack_index(std::uint64_t word) {
+    return static_cast<std::uint32_t>(word);
+  }
+  static std::uint32_t unpack_tag(std::uint64_t word) {
+    return static_cast<std::uint32_t>(word >> 32);
+  }
+
+  // Chunk k holds first_chunk_size << k nodes, numbered consecutively.
+  static size_type chunk_begin(size_type chunk) {
+    return first_chunk_size * ((size_type(1) << chunk) - 1);
+  }
+  static size_type chunk_of(size_type index) {
+    size_type scaled = index / first_chunk_size + 1, chunk = 0;
+    while (scaled >>= 1) {
+      ++chunk;
+    }
+    return chunk;
+  }
+  Node& to_node(std::uint32_t index) const {
+    size_type chunk = chunk_of(index);
+    return chunks_[chunk].load(std::memory_order_acquire)[
+      index - chunk_begin(chunk)];
+  }
+
+  void push_index(std::atomic<std::uint64_t>& head, std::uint32_t index) {
+    Node& node = to_node(index);
+    std::uint64_t old_head = head.load(std::memory_order_relaxed);
+    do {
+      node.next.store(unpack_index(old_head), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(
+               old_head, pack(index, unpack_tag(old_head) + 1),
+               std::memory_order_release, std::memory_order_relaxed));
+  }
+  std::uint32_t pop_index(std::atomic<std::uint64_t>& head) {
+    std::uint64_t old_head = head.load(std::memory_order_acquire);
+    while (unpack_index(old_head) != null_index) {
+      // The node may be popped and reused under us; a stale next is then
+      // rejected by the compare-exchange because the tag has moved on.
+      std::uint32_t next =
+        to_node(unpack_index(old_head)).next.load(std::memory_order_relaxed);
+      if (head.compare_exchange_weak(
+            old_head, pack(next, unpack_tag(old_head) + 1),
+            std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return unpack_index(old_head);
+      }
+    }
+    return null_index;
+  }
+  std::uint32_t acquire_node() {
+    std::uint32_t index = pop_index(free_);
+    while (index == null_index) {
+      {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        if (unpack_index(free_.load(std::memory_order_acquire)) ==
+            null_index) {
+          add_chunk();
+        }
+      }
+      index = pop_index(free_);
+    }
+    return index;
+  }
+  // Must hold grow_mutex_.
+  void add_chunk() {
+    if (num_chunks_ == max_chunks) {
+      throw std::length_error("LockFreeStack node pool is exhausted.");
+    }
+    size_type chunk = num_chunks_, n = first_chunk_size << chunk;
+    Node* nodes = new Node[n];
+    chunks_[chunk].store(nodes, std::memory_order_release);
+    ++num_chunks_;
+    std::uint32_t first = static_cast<std::uint32_t>(chunk_begin(chunk));
+    for (size_type i = 0; i + 1 < n; ++i) {
+      nodes[i].next.store(static_cast<std::uint32_t>(first + i + 1),
+                          std::memory_order_relaxed);
+    }
+    // Splice the whole chunk onto the free list with one update.
+    std::uint64_t old_head = free_.load(std::memory_order_relaxed);
+    do {
+      nodes[n - 1].next.store(unpack_index(old_head),
+                              std::memory_order_relaxed);
+    } while (!free_.compare_exchange_weak(
+               old_head, pack(first, unpack_tag(old_head) + 1),
+               std::memory_order_release, std::memory_order_relaxed));
+  }
+  size_type pool_capacity() const { return chunk_begin(num_chunks_); }
+  size_type count_free() const {
+    size_type count = 0;
+    std::uint32_t index = unpack_index(free_.load(std::memory_order_acquire));
+    while (index != null_index && count < pool_capacity()) {
+      index = to_node(index).next.load(std::memory_order_relaxed);
+      ++count;
+    }
+    return count;
+  }
+
+  std::atomic<std::uint64_t> top_;
+  std::atomic<std::uint64_t> free_;
+  std::atomic<Node*> chunks_[max_chunks];
+  size_type num_chunks_;
+  std::mutex grow_mutex_;
+};
+
+template <typename Tp>
+constexpr std::uint32_t LockFreeStack<Tp>::null_index;
+template <typename Tp>
+constexpr typename LockFreeStack<Tp>::size_type
+  LockFreeStack<Tp>::first_chunk_size;
+template <typename Tp>
+constexpr typename LockFreeStack<Tp>::size_type LockFreeStack<Tp>::max_chunks;
+
+#endif  // LOCK_FREE_STACK_H_
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef SMALL_STACK_H_
+#define SMALL_STACK_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Stack that keeps its first inline_capacity elements inside the object
+ * and the rest in heap chunks of chunk_size elements. Elements never move
+ * once pushed.
+ *
+ * Chunks emptied by pop() are retained while the number of spare chunks
+ * does not exceed the number in use (and at least one spare is always
+ * kept), so a stack whose depth oscillates does not hit the allocator.
+ * Capacity requested by reserve() is never given back by pop().
+ */
+template <typename Tp, std::size_t inline_capacity = 16,
+          std::size_t chunk_size = 256>
+class SmallStack {
+  static_assert(chunk_size > 0, "chunk_size must be positive.");
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+
+  SmallStack() : size_(0), reserved_chunks_(0) {}
+  SmallStack(const SmallStack& other) : size_(0), reserved_chunks_(0) {
+    while (capacity() < other.size_) {
+      add_chunk();
+    }
+    for (size_type i = 0; i < other.size_; ++i) {
+      push(*other.at(i));
+    }
+  }
+  SmallStack(SmallStack&& other) : size_(0), reserved_chunks_(0) {
+    steal(other);
+  }
+  SmallStack& operator=(const SmallStack& rhs) {
+    if (this != &rhs) {
+      SmallStack copy(rhs);
+      clear();
+      release_chunks(0);
+      steal(copy);
+    }
+    return *this;
+  }
+  SmallStack& operator=(SmallStack&& rhs) {
+    if (this != &rhs) {
+      clear();
+      release_chunks(0);
+      steal(rhs);
+    }
+    return *this;
+  }
+  virtual ~SmallStack() {
+    clear();
+    release_chunks(0);
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  size_type capacity() const {
+    return inline_capacity + chunks_.size() * chunk_size;
+  }
+  void clear() {
+    while (size_ > 0) {
+      --size_;
+      at(size_)->~Tp();
+    }
+    trim_spare_chunks();
+  }
+  void reserve(size_type new_capacity) {
+    while (capacity() < new_capacity) {
+      add_chunk();
+    }
+    if (chunks_.size() > reserved_chunks_) {
+      reserved_chunks_ = chunks_.size();
+    }
+  }
+  // Frees every chunk that holds no element, including reserved ones.
+  void shrink_to_fit() {
+    reserved_chunks_ = 0;
+    release_chunks(used_chunks());
+  }
+
+  reference top() {
+    require_nonempty("SmallStack::top()");
+    return *at(size_ - 1);
+  }
+  const_reference top() const {
+    require_nonempty("SmallStack::top()");
+    return *at(size_ - 1);
+  }
+
+  void push(const value_type& value) { emplace(value); }
+  void push(value_type&& value) { emplace(std::move(value)); }
+  template <typename... Args>
+  reference emplace(Args&&... args) {
+    if (size_ == capacity()) {
+      add_chunk();
+    }
+    Tp* slot = at(size_);
+    ::new (static_cast<void*>(slot)) Tp(std::forward<Args>(args)...);
+    ++size_;
+    return *slot;
+  }
+  void pop() {
+    require_nonempty("SmallStack::pop()");
+    --size_;
+    at(size_)->~Tp();
+    if (size_ >= inline_capacity &&
+        (size_ - inline_capacity) % chunk_size == 0) {
+      trim_spare_chunks();
+    }
+  }
+
+protected:
+  typedef typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type
+    Storage;
+  struct Chunk {
+    Storage data[chunk_size];
+  };
+
+  Tp* at(size_type index) {
+    if (index < inline_capacity) {
+      return reinterpret_cast<Tp*>(&inline_data_[index]);
+    }
+    index -= inline_capacity;
+    return reinterpret_cast<Tp*>(
+      &chunks_[index / chunk_size]->data[index % chunk_size]);
+  }
+  const Tp* at(size_type index) const {
+    return const_cast<SmallStack*>(this)->at(index);
+  }
+  size_type used_chunks() const {
+    return size_ <= inline_capacity ?
+           0 : (size_ - inline_capacity + chunk_size - 1) / chunk_size;
+  }
+  // Room for the pointer is made before the chunk is allocated, so that
+  // push_back cannot throw and leak it. The room grows geometrically.
+  void add_chunk() {
+    if (chunks_.size() == chunks_.capacity()) {
+      chunks_.reserve(std::max(2 * chunks_.size(), chunks_.size() + 1));
+    }
+    chunks_.push_back(new Chunk());
+  }
+  void release_chunks(size_type keep) {
+    while (chunks_.size() > keep) {
+      delete chunks_.back();
+      chunks_.pop_back();
+    }
+  }
+  void trim_spare_chunks() {
+    size_type used = used_chunks();
+    size_type keep = used + (used > 1 ? used : 1);
+    release_chunks(keep > reserved_chunks_ ? keep : reserved_chunks_);
+  }
+  void steal(SmallStack& other) {
+    // Heap chunks change hands; inline elements have to be moved.
+    size_type n = other.size_ < inline_capacity ?
+                  other.size_ : inline_capacity;
+    for (size_type i = 0; i < n; ++i) {
+      Tp* source = other.at(i);
+      ::new (static_cast<void*>(at(i))) Tp(std::move(*source));
+      source->~Tp();
+    }
+    chunks_.swap(other.chunks_);
+    size_ = other.size_;
+    reserved_chunks_ = other.reserved_chunks_;
+    other.size_ = 0;
+    other.reserved_chunks_ = 0;
+  }
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the stack is empty.");
+    }
+  }
+
+  size_type size_;
+  size_type reserved_chunks_;
+  Storage inline_data_[inline_capacity == 0 ? 1 : inline_capacity];
+  std::vector<Chunk*> chunks_;
+};
+
+#endif  // SMALL_STACK_H_
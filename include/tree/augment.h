@@ -0,0 +1,120 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef AUGMENT_H_
+#define AUGMENT_H_
+
+#include <algorithm>
+#include <type_traits>
+
+#include "tree/key_of_value.h"
+
+/*
+ * Augmentation policies for RBTreeBase. Every node keeps a summary of the
+ * values in its subtree, recomputed from its children whenever the tree
+ * changes shape, so that queries over a key range combine O(log n)
+ * summaries instead of visiting every value. A policy is stateless, like
+ * KeyOfValue, and provides
+ *
+ *   typedef ... summary_type;
+ *   summary_type summarize(const Value& value) const;
+ *   summary_type combine(const summary_type& left,
+ *                        const summary_type& right) const;
+ *
+ * where combine is associative. It is always given the summaries of
+ * adjacent runs of values in key order, left before right, so it need not
+ * be commutative, and it is never given an empty run, so no identity
+ * element is needed.
+ */
+
+// The default: nodes carry no summary.
+struct NoAugment {
+  struct summary_type {};
+  template <typename Value>
+  summary_type summarize(const Value&) const { return summary_type(); }
+  summary_type combine(const summary_type&, const summary_type&) const {
+    return summary_type();
+  }
+};
+
+// Where a node keeps its summary. Empty summaries take no space.
+template <typename Summary, bool = std::is_empty<Summary>::value>
+class SummarySlot {
+public:
+  const Summary& summary() const { return summary_; }
+  void set_summary(const Summary& summary) { summary_ = summary; }
+
+private:
+  Summary summary_;
+};
+template <typename Summary>
+class SummarySlot<Summary, true> {
+public:
+  Summary summary() const { return Summary(); }
+  void set_summary(const Summary&) {}
+};
+
+// Takes the mapped value of a map entry, to aggregate over maps. Such maps
+// change mapped values only through insert_or_assign and modify, which
+// keep the summaries current.
+template <typename Pair>
+struct MappedValue {
+  typedef typename Pair::second_type key_type;
+  const key_type& operator()(const Pair& value) const { return value.second; }
+};
+
+// Sum, minimum and maximum of the quantity Extract takes from each value,
+// by default the value itself.
+template <typename Value, typename Extract = IdentityKey<Value>>
+struct SumAugment {
+  typedef typename Extract::key_type summary_type;
+  summary_type summarize(const Value& value) const {
+    return Extract()(value);
+  }
+  summary_type combine(const summary_type& left,
+                       const summary_type& right) const {
+    return left + right;
+  }
+};
+template <typename Value, typename Extract = IdentityKey<Value>>
+struct MinAugment {
+  typedef typename Extract::key_type summary_type;
+  summary_type summarize(const Value& value) const {
+    return Extract()(value);
+  }
+  summary_type combine(const summary_type& left,
+                       const summary_type& right) const {
+    return std::min(left, right);
+  }
+};
+template <typename Value, typename Extract = IdentityKey<Value>>
+struct MaxAugment {
+  typedef typename Extract::key_type summary_type;
+  summary_type summarize(const Value& value) const {
+    return Extract()(value);
+  }
+  summary_type combine(const summary_type& left,
+                       const summary_type& right) const {
+    return std::max(left, right);
+  }
+};
+
+#endif  // AUGMENT_H_
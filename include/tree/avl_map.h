@@ -0,0 +1,161 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef AVL_MAP_H_
+#define AVL_MAP_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "tree/key_of_value.h"
+#include "tree/avl_tree.h"
+
+/*
+ * Map from Key to Tp on an AVL tree, with the interface of RBMap: lookups
+ * return a pointer to the mapped value or nullptr, and a transparent
+ * Compare enables lookup by other types. The AVL tree is the shallower of
+ * the two, which favours maps read far more often than written.
+ */
+template <typename Key, typename Tp, typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Tp>>>
+class AVLMap :
+  public AVLTreeBase<Key, std::pair<const Key, Tp>,
+                     FirstKey<std::pair<const Key, Tp>>, Compare, Alloc> {
+protected:
+  typedef AVLTreeBase<Key, std::pair<const Key, Tp>,
+                      FirstKey<std::pair<const Key, Tp>>, Compare, Alloc>
+    Base;
+  typedef typename Base::NodePtr NodePtr;
+
+  // Admits lookups by types other than Key only with a transparent Compare.
+  template <typename K>
+  using EnableIfTransparent =
+    typename std::enable_if<IsTransparent<Compare>::value, K>::type;
+
+public:
+  typedef Key key_type;
+  typedef Tp mapped_type;
+  typedef std::pair<const Key, Tp> value_type;
+  typedef std::size_t size_type;
+
+  AVLMap() {}
+  explicit AVLMap(const Compare& compare, const Alloc& alloc = Alloc()) :
+    Base(compare, alloc) {}
+  explicit AVLMap(const Alloc& alloc) : Base(alloc) {}
+
+  Tp* find(const Key& key) { return mapped(this->search(key)); }
+  const Tp* find(const Key& key) const { return mapped(this->search(key)); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  Tp* find(const K& key) { return mapped(this->search(key)); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  const Tp* find(const K& key) const { return mapped(this->search(key)); }
+  bool contains(const Key& key) const {
+    return this->search(key) != nullptr;
+  }
+  template <typename K, typename = EnableIfTransparent<K>>
+  bool contains(const K& key) const { return this->search(key) != nullptr; }
+  Tp& at(const Key& key) {
+    return const_cast<Tp&>(static_cast<const AVLMap&>(*this).at(key));
+  }
+  const Tp& at(const Key& key) const {
+    const Tp* value = find(key);
+    if (value == nullptr) {
+      throw std::out_of_range(
+        "AVLMap::at() is undefined for a key that is not in the map.");
+    }
+    return *value;
+  }
+  Tp& operator[](const Key& key) { return *try_emplace(key).first; }
+  Tp& operator[](Key&& key) { return *try_emplace(std::move(key)).first; }
+
+  // Each insertion returns the mapped value of key and whether it was
+  // inserted. insert and try_emplace leave an existing entry untouched, and
+  // try_emplace does not even move from its arguments then.
+  std::pair<Tp*, bool> insert(const value_type& value) {
+    return mapped(this->emplace_unique(value.first, value));
+  }
+  std::pair<Tp*, bool> insert(value_type&& value) {
+    return mapped(this->emplace_unique(value.first, std::move(value)));
+  }
+  template <typename... Args>
+  std::pair<Tp*, bool> try_emplace(const Key& key, Args&&... args) {
+    return mapped(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(key),
+      std::forward_as_tuple(std::forward<Args>(args)...)));
+  }
+  template <typename... Args>
+  std::pair<Tp*, bool> try_emplace(Key&& key, Args&&... args) {
+    return mapped(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...)));
+  }
+  template <typename Mapped>
+  std::pair<Tp*, bool> insert_or_assign(const Key& key, Mapped&& value) {
+    std::pair<Tp*, bool> result = try_emplace(key,
+                                              std::forward<Mapped>(value));
+    if (!result.second) {
+      *result.first = std::forward<Mapped>(value);
+    }
+    return result;
+  }
+  template <typename Mapped>
+  std::pair<Tp*, bool> insert_or_assign(Key&& key, Mapped&& value) {
+    std::pair<Tp*, bool> result = try_emplace(std::move(key),
+                                              std::forward<Mapped>(value));
+    if (!result.second) {
+      *result.first = std::forward<Mapped>(value);
+    }
+    return result;
+  }
+
+  // Returns whether an entry was removed.
+  bool remove(const Key& key) { return remove_key(key); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  bool remove(const K& key) { return remove_key(key); }
+
+  // Calls func(key, mapped value) in key order.
+  template <typename Function>
+  void traverse(Function func) {
+    this->inorder([&func](value_type& value) {
+      func(value.first, value.second);
+    });
+  }
+
+protected:
+  static Tp* mapped(const NodePtr& node) {
+    return node == nullptr ? nullptr : &node->value.second;
+  }
+  static std::pair<Tp*, bool> mapped(const std::pair<NodePtr, bool>& result) {
+    return std::make_pair(&result.first->value.second, result.second);
+  }
+  template <typename K>
+  bool remove_key(const K& key) {
+    bool height_decreased = false;
+    return Base::remove(this->root_, key, height_decreased) != nullptr;
+  }
+};
+
+#endif  // AVL_MAP_H_
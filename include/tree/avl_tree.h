@@ -23,25 +23,54 @@
 #ifndef AVL_TREE_H_
 #define AVL_TREE_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
-template <typename Tp>
-class AVLTree {
+#include "tree/key_of_value.h"
+#include "tree/release_tree.h"
+
+/*
+ * AVL tree of values ordered by the key KeyOfValue takes from each value,
+ * with no two keys equal. AVLTree is the set over this base and AVLMap
+ * (avl_map.h) the map.
+ */
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, typename Alloc>
+class AVLTreeBase {
 public:
-  typedef Tp value_type;
-  typedef Tp& reference;
-  typedef const Tp& const_reference;
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Value& reference;
+  typedef const Value& const_reference;
   typedef std::size_t size_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
 
-  AVLTree() : size_(0), root_(nullptr) {}
-  AVLTree(const AVLTree& other) : size_(other.size_), root_(nullptr) {
+  AVLTreeBase() : size_(0), root_(nullptr) {}
+  explicit AVLTreeBase(const Alloc& alloc) :
+    size_(0), root_(nullptr), alloc_(alloc) {}
+  explicit AVLTreeBase(const Compare& compare, const Alloc& alloc = Alloc()) :
+    size_(0), root_(nullptr), compare_(compare), alloc_(alloc) {}
+  AVLTreeBase(const AVLTreeBase& other) :
+    size_(other.size_), root_(nullptr), compare_(other.compare_),
+    alloc_(std::allocator_traits<Alloc>::
+          select_on_container_copy_construction(other.alloc_)) {
     if (!other.empty()) {
       deep_copy(root_, other.root_);
     }
   }
-  AVLTree(AVLTree&& other) : 
-    size_(std::move(other.size_)), root_(std::move(other.root_)) {}
-  AVLTree& operator=(const AVLTree& rhs) {
+  AVLTreeBase(AVLTreeBase&& other) : 
+    size_(std::move(other.size_)), root_(std::move(other.root_)),
+    compare_(other.compare_), alloc_(other.alloc_) {
+    other.size_ = 0;
+  }
+  AVLTreeBase& operator=(const AVLTreeBase& rhs) {
     size_type new_size = rhs.size_;
     NodePtr new_root = nullptr;
     if (!rhs.empty()) {
@@ -50,42 +79,175 @@ public:
     clear();
     size_ = new_size;
     root_ = new_root;
+    compare_ = rhs.compare_;
     return *this;
   }
-  AVLTree& operator=(AVLTree&& rhs) {
+  AVLTreeBase& operator=(AVLTreeBase&& rhs) {
+    clear();
     size_ = std::move(rhs.size_);
     root_ = std::move(rhs.root_);
+    compare_ = rhs.compare_;
+    rhs.size_ = 0;
     return *this;
   }
-  virtual ~AVLTree() {}
+  virtual ~AVLTreeBase() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const { return alloc_; }
   void clear() {
+    release_tree(std::move(root_), &Node::left, &Node::right);
     size_ = 0;
-    root_ = nullptr;
   }
 
-  bool find(const value_type& value) const {
-    return search(root_, value) != nullptr;
+  // Replaces the contents with [first, last), which must be sorted by key
+  // with no two keys equal. The tree is built directly in balanced shape,
+  // in linear time and without rotations.
+  template <typename ForwardIterator>
+  void build_from_sorted(ForwardIterator first, ForwardIterator last) {
+    size_type count = std::distance(first, last);
+    NodePtr new_root = build_sorted(first, count);
+    clear();
+    root_ = std::move(new_root);
+    size_ = count;
+  }
+  // As above, building the two subtrees of every range longer than
+  // grain_size in parallel on pool, a ForkJoinPool or anything with the
+  // same invoke and fork_join. Alloc must be safe to use from the pool's
+  // threads.
+  template <typename RandomAccessIterator, typename Pool>
+  void build_from_sorted(RandomAccessIterator first, RandomAccessIterator last,
+                         Pool& pool, size_type grain_size = 4096) {
+    size_type count = last - first;
+    NodePtr new_root;
+    pool.invoke([&]() {
+      new_root = build_sorted(first, count, pool, grain_size);
+    });
+    clear();
+    root_ = std::move(new_root);
+    size_ = count;
   }
 
-  void insert(const value_type& value) {
-    bool height_increased = false;
-    insert(root_, value, height_increased);
+  // Join-based set operations. Each takes the other tree by value, so pass
+  // it with std::move to hand its nodes over instead of copying them. When
+  // both trees hold a key, the value here is kept. For trees of m <= n
+  // values the union, intersection and difference take O(m log(n / m + 1))
+  // time, and their pool overloads run the two halves of every step in
+  // parallel while both sides are taller than a tree of grain_size values.
+
+  // Appends right, whose keys must all be greater than those here.
+  void join(AVLTreeBase right) {
+    size_type right_size = right.size_;
+    root_ = join_subtrees(whole(), right.whole()).root;
+    size_ += right_size;
   }
-  void remove(const value_type& value) {
-    bool height_decreased = false;
-    remove(root_, value, height_decreased);
+  // Moves the values whose keys are not less than key into greater,
+  // replacing its contents, and returns whether key was here.
+  bool split(const Key& key, AVLTreeBase& greater) {
+    Subtree less, more;
+    NodePtr equal;
+    split_subtree(whole(), key, less, equal, more);
+    bool found = equal != nullptr;
+    if (found) {
+      more = join_subtrees(Subtree(), std::move(equal), std::move(more));
+    }
+    greater.clear();
+    greater.root_ = std::move(more.root);
+    greater.size_ = size_of(greater.root_);
+    root_ = std::move(less.root);
+    size_ -= greater.size_;
+    return found;
+  }
+  void union_with(AVLTreeBase other) {
+    unite_trees(other, SequentialFork());
+  }
+  template <typename Pool>
+  void union_with(AVLTreeBase other, Pool& pool,
+                  size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      unite_trees(other, ParallelFork<Pool>(pool, grain_size));
+    });
+  }
+  void intersect_with(AVLTreeBase other) {
+    intersect_trees(other, SequentialFork());
+  }
+  template <typename Pool>
+  void intersect_with(AVLTreeBase other, Pool& pool,
+                      size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      intersect_trees(other, ParallelFork<Pool>(pool, grain_size));
+    });
+  }
+  void difference_with(AVLTreeBase other) {
+    subtract_trees(other, SequentialFork());
+  }
+  template <typename Pool>
+  void difference_with(AVLTreeBase other, Pool& pool,
+                       size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      subtract_trees(other, ParallelFork<Pool>(pool, grain_size));
+    });
+  }
+  // Keeps only the values for which pred returns true, in linear time.
+  // The pool overload calls pred from several threads at once.
+  template <typename Predicate>
+  void filter(Predicate pred) {
+    filter_tree(pred, SequentialFork());
+  }
+  template <typename Predicate, typename Pool>
+  void filter(Predicate pred, Pool& pool, size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      filter_tree(pred, ParallelFork<Pool>(pool, grain_size));
+    });
   }
 
-  void preorder(void (*func)(value_type&)) {
+  // Order statistics, in O(log n) from the subtree sizes in the nodes.
+  // select returns the value with k smaller keys, counting from zero;
+  // rank counts the keys less than key, and count_range those not less
+  // than first and less than last.
+  const_reference select(size_type k) const {
+    if (k >= size_) {
+      throw std::out_of_range(
+        "AVLTree::select() is undefined when k is not less than the size.");
+    }
+    const Node* iter = root_.get();
+    for (size_type left_size = size_of(iter->left); k != left_size;
+         left_size = size_of(iter->left)) {
+      if (k < left_size) {
+        iter = iter->left.get();
+      } else {
+        k -= left_size + 1;
+        iter = iter->right.get();
+      }
+    }
+    return iter->value;
+  }
+  size_type rank(const Key& key) const {
+    size_type less = 0;
+    for (const Node* iter = root_.get(); iter != nullptr;) {
+      if (compare_(KeyOfValue()(iter->value), key)) {
+        less += size_of(iter->left) + 1;
+        iter = iter->right.get();
+      } else {
+        iter = iter->left.get();
+      }
+    }
+    return less;
+  }
+  size_type count_range(const Key& first, const Key& last) const {
+    return compare_(first, last) ? rank(last) - rank(first) : 0;
+  }
+
+  template <typename Function>
+  void preorder(Function func) {
     preorder(root_, func);
   }
-  void inorder(void (*func)(value_type&)) {
+  template <typename Function>
+  void inorder(Function func) {
     inorder(root_, func);
   }
-  void postorder(void (*func)(value_type&)) {
+  template <typename Function>
+  void postorder(Function func) {
     postorder(root_, func);
   }
 
@@ -102,48 +264,77 @@ protected:
   struct Node;
   typedef std::shared_ptr<Node> NodePtr;
   struct Node {
-    Node() : value(Tp()), left(nullptr), right(nullptr), 
-             balance(equal_height) {}
-    explicit Node(const Tp& x) : value(x), left(nullptr), right(nullptr),
-                                 balance(equal_height) {}
-    explicit Node(Tp&& x) : value(x), left(nullptr), right(nullptr),
-                            balance(equal_height) {}
-    Tp value;
+    Node() : value(Value()), left(nullptr), right(nullptr), 
+             balance(equal_height), size(1) {}
+    template <typename... Args>
+    explicit Node(Args&&... args) : value(std::forward<Args>(args)...),
+                                    left(nullptr), right(nullptr),
+                                    balance(equal_height), size(1) {}
+    Value value;
     NodePtr left;
     NodePtr right;
     BalanceFactor balance;
+    // The number of nodes in the subtree rooted here.
+    size_type size;
   };
 
   void deep_copy(NodePtr& copy_ptr, const NodePtr& other_ptr) {
     if (other_ptr != nullptr) {
-      copy_ptr = std::make_shared<Node>(other_ptr->value);
+      copy_ptr = std::allocate_shared<Node>(alloc_, other_ptr->value);
+      copy_ptr->balance = other_ptr->balance;
+      copy_ptr->size = other_ptr->size;
       deep_copy(copy_ptr->left, other_ptr->left);
       deep_copy(copy_ptr->right, other_ptr->right);
     }    
   }
-  void search(const NodePtr& sub_root, const value_type& value) const {
-    NodePtr iter_ptr = sub_root;
-    while (iter_ptr != nullptr && iter_ptr->value != value) {
-      if (iter_ptr->value > value) {
+  const Key& key_of(const NodePtr& node) const {
+    return KeyOfValue()(node->value);
+  }
+  // Accepts any type that compare_ can order against the keys.
+  template <typename K>
+  NodePtr search(const K& key) const {
+    NodePtr iter_ptr = root_;
+    while (iter_ptr != nullptr) {
+      if (compare_(key, key_of(iter_ptr))) {
         iter_ptr = iter_ptr->left;
-      } else {
+      } else if (compare_(key_of(iter_ptr), key)) {
         iter_ptr = iter_ptr->right;
+      } else {
+        break;
       }
     }
     return iter_ptr;    
   }
-  void insert(NodePtr& sub_root, const value_type& value, 
-              bool& height_increased) {
-    if (sub_root != nullptr && sub_root->value == value) {
-      height_increased = false;
-      return;
+  // Links the node built from args unless a node with an equal key is
+  // already present; the key is looked up before anything is built.
+  template <typename K, typename... Args>
+  std::pair<NodePtr, bool> emplace_unique(const K& key, Args&&... args) {
+    NodePtr existing = search(key);
+    if (existing != nullptr) {
+      return std::make_pair(existing, false);
     }
+    NodePtr insert_node = std::allocate_shared<Node>(
+      alloc_, std::forward<Args>(args)...);
+    bool height_increased = false;
+    insert(root_, insert_node, height_increased);
+    return std::make_pair(insert_node, true);
+  }
+  // Links insert_node into sub_root. If a node with an equal key is found
+  // instead, nothing changes and that node is returned.
+  NodePtr insert(NodePtr& sub_root, const NodePtr& insert_node, 
+                 bool& height_increased) {
     if (sub_root == nullptr) {
-      sub_root = std::make_shared<Node>(value);
+      sub_root = insert_node;
       height_increased = true;
       ++size_;
-    } else if (sub_root->value > value) {
-      insert(sub_root->left, value, height_increased);
+      return nullptr;
+    }
+    NodePtr existing;
+    if (compare_(key_of(insert_node), key_of(sub_root))) {
+      existing = insert(sub_root->left, insert_node, height_increased);
+      if (existing == nullptr) {
+        ++sub_root->size;
+      }
       if (height_increased) {
         if (sub_root->balance == left_higher) {
           balance_left(sub_root);
@@ -155,8 +346,11 @@ protected:
           sub_root->balance = left_higher;
         }
       }
-    } else {
-      insert(sub_root->right, value, height_increased);
+    } else if (compare_(key_of(sub_root), key_of(insert_node))) {
+      existing = insert(sub_root->right, insert_node, height_increased);
+      if (existing == nullptr) {
+        ++sub_root->size;
+      }
       if (height_increased) {
         if (sub_root->balance == left_higher) {
           sub_root->balance = equal_height;
@@ -168,60 +362,449 @@ protected:
           sub_root->balance = right_higher;
         }
       }
+    } else {
+      height_increased = false;
+      existing = sub_root;
     }
+    return existing;
   }
-  void remove(NodePtr& rm_ptr, const value_type& value, 
-              bool& height_decreased) {
+  // Unlinks the node with an equal key and returns it, or nullptr if there
+  // is none. A node with two children is replaced by the node holding the
+  // largest key on its left, so nodes move but values are never copied.
+  template <typename K>
+  NodePtr remove(NodePtr& rm_ptr, const K& key, bool& height_decreased) {
     if (rm_ptr == nullptr) {
-      return;
+      height_decreased = false;
+      return nullptr;
     }
-    if (rm_ptr->value == value) {
+    NodePtr removed;
+    if (compare_(key, key_of(rm_ptr))) {
+      removed = remove(rm_ptr->left, key, height_decreased);
+      if (removed != nullptr) {
+        --rm_ptr->size;
+      }
+      if (height_decreased) {
+        left_shrunk(rm_ptr, height_decreased);
+      }
+    } else if (compare_(key_of(rm_ptr), key)) {
+      removed = remove(rm_ptr->right, key, height_decreased);
+      if (removed != nullptr) {
+        --rm_ptr->size;
+      }
+      if (height_decreased) {
+        right_shrunk(rm_ptr, height_decreased);
+      }
+    } else {
+      removed = rm_ptr;
       if (rm_ptr->left == nullptr || rm_ptr->right == nullptr) {
-        NodePtr child_ptr = rm_ptr->left != nullptr ? 
-                            rm_ptr->left : rm_ptr->right;
-        rm_ptr = child_ptr;
+        rm_ptr = rm_ptr->left != nullptr ? rm_ptr->left : rm_ptr->right;
         height_decreased = true;
-        --size_;
       } else {
-        NodePtr replace_ptr = max(rm_ptr->left);
-        rm_ptr->value = replace_ptr->value;
-        remove(rm_ptr->left, rm_ptr->value, height_decreased);
+        NodePtr replace_ptr;
+        remove_max(rm_ptr->left, replace_ptr, height_decreased);
+        replace_ptr->left = rm_ptr->left;
+        replace_ptr->right = rm_ptr->right;
+        replace_ptr->balance = rm_ptr->balance;
+        replace_ptr->size = rm_ptr->size - 1;
+        rm_ptr = replace_ptr;
+        if (height_decreased) {
+          left_shrunk(rm_ptr, height_decreased);
+        }
       }
-    } else if (rm_ptr->value > value) {
-      remove(rm_ptr->left, value, height_decreased);
+      removed->left = nullptr;
+      removed->right = nullptr;
+      --size_;
+    }
+    return removed;
+  }
+  void remove_max(NodePtr& sub_root, NodePtr& max_ptr, 
+                  bool& height_decreased) {
+    if (sub_root->right != nullptr) {
+      remove_max(sub_root->right, max_ptr, height_decreased);
+      --sub_root->size;
       if (height_decreased) {
-        if (rm_ptr->balance == left_higher) {
-          rm_ptr->balance = equal_height;
-          height_decreased = false;
-        } else if (rm_ptr->balance == right_higher) {
-          balance_right(rm_ptr);
-          height_decreased = false;
-        } else {
-          rm_ptr->balance = right_higher;
-        }
+        right_shrunk(sub_root, height_decreased);
       }
     } else {
-      remove(rm_ptr->right, value, height_decreased);
-      if (height_decreased) {
-        if (rm_ptr->balance == left_higher) {
-          balance_left(rm_ptr);
-          height_decreased = false;
-        } else if (rm_ptr->balance == right_higher) {
-          rm_ptr->balance = equal_height;
-          height_decreased = false;
-        } else {
-          rm_ptr->balance = left_higher;
-        }
+      max_ptr = sub_root;
+      sub_root = sub_root->left;
+      height_decreased = true;
+    }
+  }
+  // Updates sub_root after its left subtree lost one level; 
+  // height_decreased tells whether sub_root lost one as well.
+  void left_shrunk(NodePtr& sub_root, bool& height_decreased) {
+    if (sub_root->balance == left_higher) {
+      sub_root->balance = equal_height;
+    } else if (sub_root->balance == equal_height) {
+      sub_root->balance = right_higher;
+      height_decreased = false;
+    } else {
+      height_decreased = balance_right(sub_root);
+    }
+  }
+  void right_shrunk(NodePtr& sub_root, bool& height_decreased) {
+    if (sub_root->balance == right_higher) {
+      sub_root->balance = equal_height;
+    } else if (sub_root->balance == equal_height) {
+      sub_root->balance = left_higher;
+      height_decreased = false;
+    } else {
+      height_decreased = balance_left(sub_root);
+    }
+  }
+  // Builds count nodes from the values starting at first, leaving first
+  // just past them. The middle value becomes the root and the right side
+  // gets any extra one, so both sides are perfectly balanced and their
+  // heights are those of complete trees of their sizes.
+  template <typename ForwardIterator>
+  NodePtr build_sorted(ForwardIterator& first, size_type count) {
+    if (count == 0) {
+      return nullptr;
+    }
+    size_type left_count = (count - 1) / 2;
+    NodePtr left_ptr = build_sorted(first, left_count);
+    NodePtr node = std::allocate_shared<Node>(alloc_, *first);
+    ++first;
+    node->left = std::move(left_ptr);
+    node->right = build_sorted(first, count - 1 - left_count);
+    node->size = count;
+    set_built_balance(node, left_count, count - 1 - left_count);
+    return node;
+  }
+  template <typename RandomAccessIterator, typename Pool>
+  NodePtr build_sorted(RandomAccessIterator first, size_type count,
+                       Pool& pool, size_type grain_size) {
+    if (count <= grain_size) {
+      return build_sorted(first, count);
+    }
+    size_type left_count = (count - 1) / 2;
+    size_type right_count = count - 1 - left_count;
+    NodePtr node = std::allocate_shared<Node>(alloc_, first[left_count]);
+    pool.fork_join(
+      [&]() {
+        node->left = build_sorted(first, left_count, pool, grain_size);
+      },
+      [&]() {
+        node->right = build_sorted(first + (left_count + 1), right_count,
+                                   pool, grain_size);
+      });
+    node->size = count;
+    set_built_balance(node, left_count, right_count);
+    return node;
+  }
+  static size_type size_of(const NodePtr& node) {
+    return node == nullptr ? 0 : node->size;
+  }
+  static void update_size(const NodePtr& node) {
+    node->size = 1 + size_of(node->left) + size_of(node->right);
+  }
+  static void set_built_balance(const NodePtr& node, size_type left_count,
+                                size_type right_count) {
+    node->balance = complete_height(right_count) >
+                    complete_height(left_count) ?
+                    right_higher : equal_height;
+  }
+  static size_type complete_height(size_type count) {
+    size_type height = 0;
+    for (; count != 0; count >>= 1) {
+      ++height;
+    }
+    return height;
+  }
+
+  // A detached subtree and its height. The join-based operations carry
+  // heights along and derive those of the children from the balance
+  // factors, so no height is ever measured below the root.
+  struct Subtree {
+    Subtree() : root(nullptr), height(0) {}
+    Subtree(NodePtr root_ptr, size_type root_height) :
+      root(std::move(root_ptr)), height(root_height) {}
+    NodePtr root;
+    size_type height;
+  };
+  // Runs the two halves of a set operation one after the other.
+  struct SequentialFork {
+    template <typename Left, typename Right>
+    void operator()(size_type, const Left& left, const Right& right) const {
+      left();
+      right();
+    }
+  };
+  // Runs them in parallel on pool while the subtrees are tall enough.
+  template <typename Pool>
+  struct ParallelFork {
+    ParallelFork(Pool& fork_pool, size_type grain_size) :
+      pool(fork_pool), grain_height(complete_height(grain_size)) {}
+    template <typename Left, typename Right>
+    void operator()(size_type height, const Left& left,
+                    const Right& right) const {
+      if (height > grain_height) {
+        pool.fork_join(left, right);
+      } else {
+        left();
+        right();
       }
-    }    
+    }
+    Pool& pool;
+    size_type grain_height;
+  };
+
+  // Takes the nodes out as a subtree, leaving size_ to the caller.
+  Subtree whole() {
+    size_type height = 0;
+    for (Node* iter = root_.get(); iter != nullptr; ++height) {
+      iter = iter->balance == right_higher ? iter->right.get() :
+                                             iter->left.get();
+    }
+    return Subtree(std::move(root_), height);
+  }
+  // Detaches the children of tree.root.
+  static void expose(Subtree& tree, Subtree& left, Subtree& right) {
+    left.height = tree.height - (tree.root->balance == right_higher ? 2 : 1);
+    right.height = tree.height - (tree.root->balance == left_higher ? 2 : 1);
+    left.root = std::move(tree.root->left);
+    right.root = std::move(tree.root->right);
+  }
+  // Hangs left and right, at most one level apart, under node.
+  static Subtree attach(NodePtr node, Subtree left, Subtree right) {
+    node->balance = left.height > right.height ? left_higher :
+                    left.height < right.height ? right_higher : equal_height;
+    size_type height = std::max(left.height, right.height) + 1;
+    node->left = std::move(left.root);
+    node->right = std::move(right.root);
+    update_size(node);
+    return Subtree(std::move(node), height);
+  }
+  // As attach, but left and right may be two levels apart, which a single
+  // or double rotation evens out.
+  static Subtree attach_rotated(NodePtr node, Subtree left, Subtree right) {
+    if (right.height > left.height + 1) {
+      Subtree right_left, right_right;
+      NodePtr right_node = right.root;
+      expose(right, right_left, right_right);
+      if (right_right.height >= right_left.height) {
+        return attach(std::move(right_node),
+                      attach(std::move(node), std::move(left),
+                             std::move(right_left)),
+                      std::move(right_right));
+      }
+      Subtree middle_left, middle_right;
+      NodePtr middle_node = right_left.root;
+      expose(right_left, middle_left, middle_right);
+      return attach(std::move(middle_node),
+                    attach(std::move(node), std::move(left),
+                           std::move(middle_left)),
+                    attach(std::move(right_node), std::move(middle_right),
+                           std::move(right_right)));
+    }
+    if (left.height > right.height + 1) {
+      Subtree left_left, left_right;
+      NodePtr left_node = left.root;
+      expose(left, left_left, left_right);
+      if (left_left.height >= left_right.height) {
+        return attach(std::move(left_node), std::move(left_left),
+                      attach(std::move(node), std::move(left_right),
+                             std::move(right)));
+      }
+      Subtree middle_left, middle_right;
+      NodePtr middle_node = left_right.root;
+      expose(left_right, middle_left, middle_right);
+      return attach(std::move(middle_node),
+                    attach(std::move(left_node), std::move(left_left),
+                           std::move(middle_left)),
+                    attach(std::move(node), std::move(middle_right),
+                           std::move(right)));
+    }
+    return attach(std::move(node), std::move(left), std::move(right));
+  }
+  // Joins left, node and right, in key order, descending the spine of the
+  // taller side to where the shorter one fits and rebalancing on the way
+  // back up, in time proportional to their difference in height.
+  static Subtree join_subtrees(Subtree left, NodePtr node, Subtree right) {
+    if (left.height > right.height + 1) {
+      Subtree left_left, left_right;
+      NodePtr left_node = left.root;
+      expose(left, left_left, left_right);
+      return attach_rotated(std::move(left_node), std::move(left_left),
+                            join_subtrees(std::move(left_right),
+                                          std::move(node), std::move(right)));
+    }
+    if (right.height > left.height + 1) {
+      Subtree right_left, right_right;
+      NodePtr right_node = right.root;
+      expose(right, right_left, right_right);
+      return attach_rotated(std::move(right_node),
+                            join_subtrees(std::move(left), std::move(node),
+                                          std::move(right_left)),
+                            std::move(right_right));
+    }
+    return attach(std::move(node), std::move(left), std::move(right));
+  }
+  static Subtree join_subtrees(Subtree left, Subtree right) {
+    if (left.root == nullptr) {
+      return right;
+    }
+    Subtree rest;
+    NodePtr last;
+    split_last(std::move(left), rest, last);
+    return join_subtrees(std::move(rest), std::move(last), std::move(right));
+  }
+  static void split_last(Subtree tree, Subtree& rest, NodePtr& last) {
+    Subtree left, right;
+    NodePtr node = tree.root;
+    expose(tree, left, right);
+    if (right.root == nullptr) {
+      rest = std::move(left);
+      last = std::move(node);
+      return;
+    }
+    split_last(std::move(right), rest, last);
+    rest = join_subtrees(std::move(left), std::move(node), std::move(rest));
+  }
+  // Splits tree into the values with keys less than key, the node with an
+  // equal key if any, and those with greater keys.
+  template <typename K>
+  void split_subtree(Subtree tree, const K& key, Subtree& less,
+                     NodePtr& equal, Subtree& greater) const {
+    if (tree.root == nullptr) {
+      less = Subtree();
+      equal = nullptr;
+      greater = Subtree();
+      return;
+    }
+    Subtree left, right;
+    NodePtr node = tree.root;
+    expose(tree, left, right);
+    if (compare_(key, key_of(node))) {
+      split_subtree(std::move(left), key, less, equal, greater);
+      greater = join_subtrees(std::move(greater), std::move(node),
+                              std::move(right));
+    } else if (compare_(key_of(node), key)) {
+      split_subtree(std::move(right), key, less, equal, greater);
+      less = join_subtrees(std::move(left), std::move(node), std::move(less));
+    } else {
+      less = std::move(left);
+      equal = std::move(node);
+      greater = std::move(right);
+    }
+  }
+  // Each operation below splits one tree by the root key of the other,
+  // recurses on the two pairs of halves and joins the results.
+  template <typename Fork>
+  Subtree unite(Subtree tree, Subtree other, const Fork& fork) const {
+    if (tree.root == nullptr) {
+      return other;
+    }
+    if (other.root == nullptr) {
+      return tree;
+    }
+    size_type fork_height = std::min(tree.height, other.height);
+    Subtree left, right, other_less, other_greater;
+    NodePtr node = tree.root, other_equal;
+    expose(tree, left, right);
+    split_subtree(std::move(other), key_of(node), other_less, other_equal,
+                  other_greater);
+    fork(fork_height,
+      [&]() { left = unite(std::move(left), std::move(other_less), fork); },
+      [&]() {
+        right = unite(std::move(right), std::move(other_greater), fork);
+      });
+    return join_subtrees(std::move(left), std::move(node), std::move(right));
   }
-  void balance_left(NodePtr& sub_root) {
+  template <typename Fork>
+  Subtree intersect(Subtree tree, Subtree other, const Fork& fork) const {
+    if (tree.root == nullptr || other.root == nullptr) {
+      return Subtree();
+    }
+    size_type fork_height = std::min(tree.height, other.height);
+    Subtree left, right, other_less, other_greater;
+    NodePtr node = tree.root, other_equal;
+    expose(tree, left, right);
+    split_subtree(std::move(other), key_of(node), other_less, other_equal,
+                  other_greater);
+    fork(fork_height,
+      [&]() {
+        left = intersect(std::move(left), std::move(other_less), fork);
+      },
+      [&]() {
+        right = intersect(std::move(right), std::move(other_greater), fork);
+      });
+    if (other_equal == nullptr) {
+      return join_subtrees(std::move(left), std::move(right));
+    }
+    return join_subtrees(std::move(left), std::move(node), std::move(right));
+  }
+  template <typename Fork>
+  Subtree subtract(Subtree tree, Subtree other, const Fork& fork) const {
+    if (tree.root == nullptr || other.root == nullptr) {
+      return tree;
+    }
+    size_type fork_height = std::min(tree.height, other.height);
+    Subtree other_left, other_right, less, greater;
+    NodePtr other_node = other.root, equal;
+    expose(other, other_left, other_right);
+    split_subtree(std::move(tree), key_of(other_node), less, equal, greater);
+    fork(fork_height,
+      [&]() { less = subtract(std::move(less), std::move(other_left), fork); },
+      [&]() {
+        greater = subtract(std::move(greater), std::move(other_right), fork);
+      });
+    return join_subtrees(std::move(less), std::move(greater));
+  }
+  template <typename Predicate, typename Fork>
+  Subtree filter_subtree(Subtree tree, Predicate& pred, const Fork& fork) {
+    if (tree.root == nullptr) {
+      return tree;
+    }
+    size_type fork_height = tree.height;
+    Subtree left, right;
+    NodePtr node = tree.root;
+    expose(tree, left, right);
+    fork(fork_height,
+      [&]() { left = filter_subtree(std::move(left), pred, fork); },
+      [&]() { right = filter_subtree(std::move(right), pred, fork); });
+    if (!pred(node->value)) {
+      return join_subtrees(std::move(left), std::move(right));
+    }
+    return join_subtrees(std::move(left), std::move(node), std::move(right));
+  }
+  template <typename Fork>
+  void unite_trees(AVLTreeBase& other, const Fork& fork) {
+    root_ = unite(whole(), other.whole(), fork).root;
+    size_ = size_of(root_);
+  }
+  template <typename Fork>
+  void intersect_trees(AVLTreeBase& other, const Fork& fork) {
+    root_ = intersect(whole(), other.whole(), fork).root;
+    size_ = size_of(root_);
+  }
+  template <typename Fork>
+  void subtract_trees(AVLTreeBase& other, const Fork& fork) {
+    root_ = subtract(whole(), other.whole(), fork).root;
+    size_ = size_of(root_);
+  }
+  template <typename Predicate, typename Fork>
+  void filter_tree(Predicate& pred, const Fork& fork) {
+    root_ = filter_subtree(whole(), pred, fork).root;
+    size_ = size_of(root_);
+  }
+  // Rotates a subtree whose left side is two levels higher and returns
+  // whether its height went down. A left child of equal height occurs only
+  // after a removal.
+  bool balance_left(NodePtr& sub_root) {
     NodePtr sub_root_l = sub_root->left;
     if (sub_root_l->balance == left_higher) {
       sub_root->balance = equal_height;
       sub_root_l->balance = equal_height;
       rotate_right(sub_root);
-    } else if (sub_root_l->balance == right_higher) {
+      return true;
+    } else if (sub_root_l->balance == equal_height) {
+      sub_root->balance = left_higher;
+      sub_root_l->balance = right_higher;
+      rotate_right(sub_root);
+      return false;
+    } else {
       NodePtr sub_root_l_r = sub_root_l->right;
       if (sub_root_l_r->balance == right_higher) {
         sub_root->balance = equal_height;
@@ -234,17 +817,24 @@ protected:
         sub_root_l->balance = equal_height;
       }
       sub_root_l_r->balance = equal_height;
-      rotate_left(sub_root_l);
+      rotate_left(sub_root->left);
       rotate_right(sub_root);
+      return true;
     }
   }
-  void balance_right(NodePtr& sub_root) {
+  bool balance_right(NodePtr& sub_root) {
     NodePtr sub_root_r = sub_root->right;
     if (sub_root_r->balance == right_higher) {
       sub_root->balance = equal_height;
       sub_root_r->balance = equal_height;
       rotate_left(sub_root);
-    } else if (sub_root_r->balance == left_higher) {
+      return true;
+    } else if (sub_root_r->balance == equal_height) {
+      sub_root->balance = right_higher;
+      sub_root_r->balance = left_higher;
+      rotate_left(sub_root);
+      return false;
+    } else {
       NodePtr sub_root_r_l = sub_root_r->left;
       if (sub_root_r_l->balance == left_higher) {
         sub_root->balance = equal_height;
@@ -259,6 +849,7 @@ protected:
       sub_root_r_l->balance = equal_height;
       rotate_right(sub_root->right);
       rotate_left(sub_root);
+      return true;
     }
   }
   void rotate_left(NodePtr& sub_root) {
@@ -268,6 +859,8 @@ protected:
     NodePtr sub_root_r = sub_root->right;
     sub_root->right = sub_root_r->left;
     sub_root_r->left = sub_root;
+    sub_root_r->size = sub_root->size;
+    update_size(sub_root);
     sub_root = sub_root_r;
   }
   void rotate_right(NodePtr& sub_root) {
@@ -277,28 +870,33 @@ protected:
     NodePtr sub_root_l = sub_root->left;
     sub_root->left = sub_root_l->right;
     sub_root_l->right = sub_root;
+    sub_root_l->size = sub_root->size;
+    update_size(sub_root);
     sub_root = sub_root_l;
   }
 
-  void preorder(NodePtr& sub_root, void (*func)(value_type&)) {
+  template <typename Function>
+  void preorder(NodePtr& sub_root, Function& func) {
     if (sub_root != nullptr) {
-      (*func)(sub_root->value);
+      func(sub_root->value);
       preorder(sub_root->left, func);
       preorder(sub_root->right, func);
     }
   }
-  void inorder(NodePtr& sub_root, void (*func)(value_type&)) {
+  template <typename Function>
+  void inorder(NodePtr& sub_root, Function& func) {
     if (sub_root != nullptr) {      
       inorder(sub_root->left, func);
-      (*func)(sub_root->value);
+      func(sub_root->value);
       inorder(sub_root->right, func);
     }
   }
-  void postorder(NodePtr& sub_root, void (*func)(value_type&)) {
+  template <typename Function>
+  void postorder(NodePtr& sub_root, Function& func) {
     if (sub_root != nullptr) {
       postorder(sub_root->left, func);
       postorder(sub_root->right, func);
-      (*func)(sub_root->value);      
+      func(sub_root->value);      
     }
   }    
   NodePtr max(const NodePtr& sub_root) const {
@@ -318,6 +916,68 @@ protected:
 
   size_type size_;
   NodePtr root_;
+  Compare compare_;
+  Alloc alloc_;
+};
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
+class AVLTree :
+  public AVLTreeBase<Tp, Tp, IdentityKey<Tp>, std::less<Tp>, Alloc> {
+public:
+  typedef Tp value_type;
+  typedef std::size_t size_type;
+
+  AVLTree() {}
+  explicit AVLTree(const Alloc& alloc) : Base(alloc) {}
+
+  bool find(const value_type& value) const {
+    return this->search(value) != nullptr;
+  }
+
+  // A value equal to one already present is not inserted.
+  void insert(const value_type& value) {
+    this->emplace_unique(value, value);
+  }
+  void remove(const value_type& value) {
+    bool height_decreased = false;
+    Base::remove(this->root_, value, height_decreased);
+  }
+
+  // Inserts [first, last) by sorting it into a tree of its own and taking
+  // the union, which beats inserting one value at a time for large ranges.
+  // The pool overload builds that tree and the union in parallel, though
+  // the sort itself stays sequential.
+  template <typename InputIterator>
+  void insert_range(InputIterator first, InputIterator last) {
+    std::vector<value_type> values = sorted_unique(first, last);
+    AVLTree range(this->alloc_);
+    range.build_from_sorted(values.begin(), values.end());
+    this->union_with(std::move(range));
+  }
+  template <typename InputIterator, typename Pool>
+  void insert_range(InputIterator first, InputIterator last, Pool& pool,
+                    size_type grain_size = 4096) {
+    std::vector<value_type> values = sorted_unique(first, last);
+    AVLTree range(this->alloc_);
+    range.build_from_sorted(values.begin(), values.end(), pool, grain_size);
+    this->union_with(std::move(range), pool, grain_size);
+  }
+
+protected:
+  typedef AVLTreeBase<Tp, Tp, IdentityKey<Tp>, std::less<Tp>, Alloc> Base;
+
+  template <typename InputIterator>
+  static std::vector<value_type> sorted_unique(InputIterator first,
+                                               InputIterator last) {
+    std::vector<value_type> values(first, last);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end(),
+                             [](const value_type& lhs, const value_type& rhs) {
+                               return !(lhs < rhs);
+                             }),
+                 values.end());
+    return values;
+  }
 };
 
 #endif  // AVL_TREE_H_
\ No newline at end of file
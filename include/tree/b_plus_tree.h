@@ -0,0 +1,730 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef B_PLUS_TREE_H_
+#define B_PLUS_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "memory/node_pool.h"
+#include "tree/node_search.h"
+
+typedef std::size_t order_type;
+
+/*
+ * B+ tree mapping keys to values. Internal nodes hold only separator keys
+ * and up to order children, so more of them fit in a cache line than in a
+ * BTree node; every key/value pair lives in a leaf, and the leaves are
+ * chained in key order. A range query descends once to its first leaf and
+ * then walks the chain, as scan() and the iterators do.
+ *
+ * Keys and values are kept in separate arrays inside a leaf, so an
+ * iterator yields a pair of references rather than a stored pair. With the
+ * default comparison, the search within a node uses NodeSearch.
+ */
+template <typename Key, typename Tp, order_type order = 64,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Tp>>>
+class BPlusTree {
+protected:
+  struct Leaf;
+  template <typename ValueReference, typename LeafPtr>
+  class Iterator;
+
+public:
+  typedef Key key_type;
+  typedef Tp mapped_type;
+  typedef std::pair<const Key, Tp> value_type;
+  typedef std::size_t size_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
+
+  BPlusTree() : size_(0), height_(0), root_(nullptr) {}
+  explicit BPlusTree(const Compare& compare, const Alloc& alloc = Alloc()) :
+    size_(0), height_(0), root_(nullptr), compare_(compare), alloc_(alloc) {}
+  explicit BPlusTree(const Alloc& alloc) :
+    size_(0), height_(0), root_(nullptr), alloc_(alloc) {}
+  BPlusTree(const BPlusTree& other) :
+    size_(0), height_(0), root_(nullptr), compare_(other.compare_),
+    alloc_(std::allocator_traits<Alloc>::
+           select_on_container_copy_construction(other.alloc_)) {
+    copy_from(other);
+  }
+  BPlusTree(BPlusTree&& other) :
+    size_(0), height_(0), root_(nullptr), compare_(other.compare_),
+    alloc_(other.alloc_) {
+    swap(other);
+  }
+  BPlusTree& operator=(const BPlusTree& rhs) {
+    if (this != &rhs) {
+      BPlusTree copy(rhs.compare_, alloc_);
+      copy.copy_from(rhs);
+      swap(copy);
+    }
+    return *this;
+  }
+  BPlusTree& operator=(BPlusTree&& rhs) {
+    clear();
+    swap(rhs);
+    return *this;
+  }
+  virtual ~BPlusTree() { clear(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  allocator_type get_allocator() const { return alloc_; }
+  void clear() {
+    if (root_ != nullptr) {
+      destroy(root_, height_);
+    }
+    size_ = 0;
+    height_ = 0;
+    root_ = nullptr;
+  }
+  // Allocators are exchanged along with the nodes.
+  void swap(BPlusTree& other) {
+    std::swap(size_, other.size_);
+    std::swap(height_, other.height_);
+    std::swap(root_, other.root_);
+    std::swap(compare_, other.compare_);
+    swap_allocators(alloc_, other.alloc_);
+  }
+
+  typedef Iterator<Tp&, Leaf*> iterator;
+  typedef Iterator<const Tp&, const Leaf*> const_iterator;
+
+  iterator begin() { return iterator(leftmost_leaf(), 0); }
+  const_iterator begin() const { return const_iterator(leftmost_leaf(), 0); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(); }
+  const_iterator end() const { return const_iterator(); }
+  const_iterator cend() const { return end(); }
+
+  iterator find(const Key& key) {
+    const_iterator position = static_cast<const BPlusTree&>(*this).find(key);
+    return iterator(const_cast<Leaf*>(position.leaf_), position.index_);
+  }
+  const_iterator find(const Key& key) const {
+    if (root_ == nullptr) {
+      return end();
+    }
+    const Leaf* leaf = find_leaf(key);
+    size_type index = lower_index(leaf->keys, leaf->size, key);
+    if (index < leaf->size && !compare_(key, leaf->keys[index])) {
+      return const_iterator(leaf, index);
+    }
+    return end();
+  }
+  bool contains(const Key& key) const { return find(key) != end(); }
+  // First pair whose key is not less than key.
+  iterator lower_bound(const Key& key) {
+    const_iterator position =
+      static_cast<const BPlusTree&>(*this).lower_bound(key);
+    return iterator(const_cast<Leaf*>(position.leaf_), position.index_);
+  }
+  const_iterator lower_bound(const Key& key) const {
+    if (root_ == nullptr) {
+      return end();
+    }
+    const Leaf* leaf = find_leaf(key);
+    return const_iterator(leaf, lower_index(leaf->keys, leaf->size, key));
+  }
+  // First pair whose key is greater than key.
+  iterator upper_bound(const Key& key) {
+    const_iterator position =
+      static_cast<const BPlusTree&>(*this).upper_bound(key);
+    return iterator(const_cast<Leaf*>(position.leaf_), position.index_);
+  }
+  const_iterator upper_bound(const Key& key) const {
+    if (root_ == nullptr) {
+      return end();
+    }
+    const Leaf* leaf = find_leaf(key);
+    return const_iterator(leaf, upper_index(leaf->keys, leaf->size, key));
+  }
+
+  // Inserts the pair unless key is already present; returns whether it was
+  // inserted.
+  bool insert(const Key& key, const Tp& value) {
+    if (root_ == nullptr) {
+      Leaf* leaf = new_leaf();
+      leaf->keys[0] = key;
+      leaf->values[0] = value;
+      leaf->size = 1;
+      root_ = leaf;
+      size_ = 1;
+      return true;
+    }
+    Key separator;
+    Node* right = nullptr;
+    if (!insert(root_, height_, key, value, separator, right)) {
+      return false;
+    }
+    if (right != nullptr) {
+      Inner* new_root = new_inner();
+      new_root->size = 1;
+      new_root->keys[0] = separator;
+      new_root->children[0] = root_;
+      new_root->children[1] = right;
+      root_ = new_root;
+      ++height_;
+    }
+    ++size_;
+    return true;
+  }
+  void remove(const Key& key) {
+    if (root_ == nullptr || !remove(root_, height_, key)) {
+      return;
+    }
+    --size_;
+    if (height_ == 0) {
+      if (root_->size == 0) {
+        delete_leaf(static_cast<Leaf*>(root_));
+        root_ = nullptr;
+      }
+    } else if (root_->size == 0) {
+      Inner* old_root = static_cast<Inner*>(root_);
+      root_ = old_root->children[0];
+      --height_;
+      delete_inner(old_root);
+    }
+  }
+
+  // Calls func(key, value) for every pair with first <= key < last, in
+  // order, reading the leaves one after another.
+  template <typename Function>
+  void scan(const Key& first, const Key& last, Function func) {
+    scan_leaves(lower_bound(first), last, func);
+  }
+  template <typename Function>
+  void scan(const Key& first, const Key& last, Function func) const {
+    scan_leaves(lower_bound(first), last, func);
+  }
+  template <typename Function>
+  void traverse(Function func) {
+    for (Leaf* leaf = leftmost_leaf(); leaf != nullptr; leaf = leaf->next) {
+      for (size_type i = 0; i < leaf->size; ++i) {
+        func(static_cast<const Key&>(leaf->keys[i]), leaf->values[i]);
+      }
+    }
+  }
+  template <typename Function>
+  void traverse(Function func) const {
+    for (const Leaf* leaf = leftmost_leaf(); leaf != nullptr;
+         leaf = leaf->next) {
+      for (size_type i = 0; i < leaf->size; ++i) {
+        func(leaf->keys[i], leaf->values[i]);
+      }
+    }
+  }
+
+protected:
+  static_assert(order >= 3, "a B+ tree node needs at least three children");
+
+  static const size_type max_keys = order - 1;
+  static const size_type min_keys = (order - 1) / 2;
+
+  // The level of a node, counted from the leaves, tells whether it is a
+  // Leaf or an Inner, so nodes carry no tag.
+  struct Node {
+    Node() : size(0) {}
+    size_type size;
+  };
+  struct Inner : Node {
+    Key keys[max_keys];
+    Node* children[order];
+  };
+  struct Leaf : Node {
+    Leaf() : next(nullptr) {}
+    Key keys[max_keys];
+    Tp values[max_keys];
+    Leaf* next;
+  };
+
+  typedef std::allocator_traits<Alloc> AllocTraits;
+  typedef typename AllocTraits::template rebind_alloc<Leaf> LeafAllocator;
+  typedef typename AllocTraits::template rebind_traits<Leaf> LeafTraits;
+  typedef typename AllocTraits::template rebind_alloc<Inner> InnerAllocator;
+  typedef typename AllocTraits::template rebind_traits<Inner> InnerTraits;
+
+  template <typename ValueReference, typename LeafPtr>
+  class Iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::pair<const Key, Tp> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef std::pair<const Key&, ValueReference> reference;
+
+    Iterator() : leaf_(nullptr), index_(0) {}
+    // Allows iterator to const_iterator conversion, but not the reverse.
+    template <typename OtherReference, typename OtherLeafPtr,
+              typename = typename std::enable_if<
+                std::is_convertible<OtherLeafPtr, LeafPtr>::value>::type>
+    Iterator(const Iterator<OtherReference, OtherLeafPtr>& other) :
+      leaf_(other.leaf_), index_(other.index_) {}
+
+    const Key& key() const { return leaf_->keys[index_]; }
+    ValueReference value() const { return leaf_->values[index_]; }
+    reference operator*() const { return reference(key(), value()); }
+    Iterator& operator++() {
+      if (++index_ == leaf_->size) {
+        leaf_ = leaf_->next;
+        index_ = 0;
+      }
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    template <typename OtherReference, typename OtherLeafPtr>
+    bool operator==(
+      const Iterator<OtherReference, OtherLeafPtr>& rhs) const {
+      return leaf_ == rhs.leaf_ && index_ == rhs.index_;
+    }
+    template <typename OtherReference, typename OtherLeafPtr>
+    bool operator!=(
+      const Iterator<OtherReference, OtherLeafPtr>& rhs) const {
+      return !(*this == rhs);
+    }
+
+  private:
+    friend class BPlusTree;
+    template <typename, typename> friend class Iterator;
+    // A position one past the last pair of a leaf is moved to the start of
+    // the next leaf, so that every position has one representation.
+    Iterator(LeafPtr leaf, size_type index) : leaf_(leaf), index_(index) {
+      if (leaf_ != nullptr && index_ == leaf_->size) {
+        leaf_ = leaf_->next;
+        index_ = 0;
+      }
+    }
+    LeafPtr leaf_;
+    size_type index_;
+  };
+
+  // Number of keys less than key, and number not greater than key.
+  size_type lower_index(const Key* keys, size_type size,
+                        const Key& key) const {
+    return lower_index(keys, size, key,
+                       std::is_same<Compare, std::less<Key>>());
+  }
+  size_type lower_index(const Key* keys, size_type size, const Key& key,
+                        std::true_type) const {
+    return NodeSearch<Key>::lower_bound(keys, size, key);
+  }
+  size_type lower_index(const Key* keys, size_type size, const Key& key,
+                        std::false_type) const {
+    return std::lower_bound(keys, keys + size, key, compare_) - keys;
+  }
+  size_type upper_index(const Key* keys, size_type size,
+                        const Key& key) const {
+    size_type index = lower_index(keys, size, key);
+    while (index < size && !compare_(key, keys[index])) {
+      ++index;
+    }
+    return index;
+  }
+
+  // A separator is the first key of the subtree on its right, so keys
+  // equal to it go right.
+  const Leaf* find_leaf(const Key& key) const {
+    const Node* node = root_;
+    for (size_type level = height_; level > 0; --level) {
+      const Inner* inner = static_cast<const Inner*>(node);
+      node = inner->children[upper_index(inner->keys, inner->size, key)];
+    }
+    return static_cast<const Leaf*>(node);
+  }
+  Leaf* leftmost_leaf() const {
+    Node* node = root_;
+    for (size_type level = height_; level > 0 && node != nullptr; --level) {
+      node = static_cast<Inner*>(node)->children[0];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  template <typename Position, typename Function>
+  void scan_leaves(Position position, const Key& last, Function func) const {
+    auto leaf = position.leaf_;
+    size_type index = position.index_;
+    while (leaf != nullptr) {
+      for (; index < leaf->size; ++index) {
+        if (!compare_(leaf->keys[index], last)) {
+          return;
+        }
+        func(static_cast<const Key&>(leaf->keys[index]),
+             leaf->values[index]);
+      }
+      leaf = leaf->next;
+      index = 0;
+    }
+  }
+
+  // Inserts into the subtree at node, which is level levels above the
+  // leaves. If the node splits, its new right sibling and the key that
+  // separates them are returned through right and separator.
+  bool insert(Node* node, size_type level, const Key& key, const Tp& value,
+              Key& separator, Node*& right) {
+    if (level == 0) {
+      Leaf* leaf = static_cast<Leaf*>(node);
+      size_type index = lower_index(leaf->keys, leaf->size, key);
+      if (index < leaf->size && !compare_(key, leaf->keys[index])) {
+        return false;
+      }
+      if (leaf->size < max_keys) {
+        insert_in_leaf(leaf, index, key, value);
+      } else {
+        Leaf* sibling = split_leaf(leaf, index, key, value);
+        separator = sibling->keys[0];
+        right = sibling;
+      }
+      return true;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    size_type index = upper_index(inner->keys, inner->size, key);
+    Key child_separator;
+    Node* child_right = nullptr;
+    if (!insert(inner->children[index], level - 1, key, value,
+                child_separator, child_right)) {
+      return false;
+    }
+    if (child_right != nullptr) {
+      if (inner->size < max_keys) {
+        insert_in_inner(inner, index, child_separator, child_right);
+      } else {
+        right = split_inner(inner, index, child_separator, child_right,
+                            separator);
+      }
+    }
+    return true;
+  }
+  void insert_in_leaf(Leaf* leaf, size_type index, const Key& key,
+                      const Tp& value) {
+    for (size_type i = leaf->size; i > index; --i) {
+      leaf->keys[i] = std::move(leaf->keys[i - 1]);
+      leaf->values[i] = std::move(leaf->values[i - 1]);
+    }
+    leaf->keys[index] = key;
+    leaf->values[index] = value;
+    ++leaf->size;
+  }
+  // Splits a full leaf so that, with the new pair, the left half has
+  // (max_keys + 1) / 2 pairs; returns the new right leaf.
+  Leaf* split_leaf(Leaf* leaf, size_type index, const Key& key,
+                   const Tp& value) {
+    Leaf* sibling = new_leaf();
+    size_type middle = (max_keys + 1) / 2;
+    size_type moved_from = index < middle ? middle - 1 : middle;
+    for (size_type i = moved_from; i < leaf->size; ++i) {
+      sibling->keys[i - moved_from] = std::move(leaf->keys[i]);
+      sibling->values[i - moved_from] = std::move(leaf->values[i]);
+    }
+    sibling->size = leaf->size - moved_from;
+    leaf->size = moved_from;
+    if (index < middle) {
+      insert_in_leaf(leaf, index, key, value);
+    } else {
+      insert_in_leaf(sibling, index - middle, key, value);
+    }
+    sibling->next = leaf->next;
+    leaf->next = sibling;
+    return sibling;
+  }
+  void insert_in_inner(Inner* inner, size_type index, const Key& key,
+                       Node* right) {
+    for (size_type i = inner->size; i > index; --i) {
+      inner->keys[i] = std::move(inner->keys[i - 1]);
+      inner->children[i + 1] = inner->children[i];
+    }
+    inner->keys[index] = key;
+    inner->children[index + 1] = right;
+    ++inner->size;
+  }
+  // Splits a full inner node around the key that moves up to the parent,
+  // which is returned through separator; returns the new right node.
+  Inner* split_inner(Inner* inner, size_type index, const Key& key,
+                     Node* right, Key& separator) {
+    Key keys[max_keys + 1];
+    Node* children[order + 1];
+    for (size_type i = 0, j = 0; i <= max_keys; ++i) {
+      keys[i] = i == index ? key : std::move(inner->keys[j++]);
+    }
+    for (size_type i = 0, j = 0; i <= order; ++i) {
+      children[i] = i == index + 1 ? right : inner->children[j++];
+    }
+    Inner* sibling = new_inner();
+    size_type middle = (max_keys + 1) / 2;
+    inner->size = middle;
+    sibling->size = max_keys - middle;
+    for (size_type i = 0; i < middle; ++i) {
+      inner->keys[i] = std::move(keys[i]);
+      inner->children[i] = children[i];
+    }
+    inner->children[middle] = children[middle];
+    separator = std::move(keys[middle]);
+    for (size_type i = 0; i < sibling->size; ++i) {
+      sibling->keys[i] = std::move(keys[middle + 1 + i]);
+      sibling->children[i] = children[middle + 1 + i];
+    }
+    sibling->children[sibling->size] = children[order];
+    return sibling;
+  }
+
+  // Removes key from the subtree at node and repairs any child left with
+  // fewer than min_keys keys; the caller repairs node itself.
+  bool remove(Node* node, size_type level, const Key& key) {
+    if (level == 0) {
+      Leaf* leaf = static_cast<Leaf*>(node);
+      size_type index = lower_index(leaf->keys, leaf->size, key);
+      if (index == leaf->size || compare_(key, leaf->keys[index])) {
+        return false;
+      }
+      for (size_type i = index + 1; i < leaf->size; ++i) {
+        leaf->keys[i - 1] = std::move(leaf->keys[i]);
+        leaf->values[i - 1] = std::move(leaf->values[i]);
+      }
+      --leaf->size;
+      return true;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    size_type index = upper_index(inner->keys, inner->size, key);
+    if (!remove(inner->children[index], level - 1, key)) {
+      return false;
+    }
+    if (inner->children[index]->size < min_keys) {
+      if (level == 1) {
+        restore_leaf(inner, index);
+      } else {
+        restore_inner(inner, index);
+      }
+    }
+    return true;
+  }
+  // Refills the leaf at parent->children[index] from a sibling that can
+  // spare a pair, or else merges it with a sibling.
+  void restore_leaf(Inner* parent, size_type index) {
+    Leaf* leaf = static_cast<Leaf*>(parent->children[index]);
+    Leaf* left = index > 0 ?
+                 static_cast<Leaf*>(parent->children[index - 1]) : nullptr;
+    Leaf* right = index < parent->size ?
+                  static_cast<Leaf*>(parent->children[index + 1]) : nullptr;
+    if (left != nullptr && left->size > min_keys) {
+      --left->size;
+      insert_in_leaf(leaf, 0, left->keys[left->size],
+                     left->values[left->size]);
+      parent->keys[index - 1] = leaf->keys[0];
+    } else if (right != nullptr && right->size > min_keys) {
+      leaf->keys[leaf->size] = std::move(right->keys[0]);
+      leaf->values[leaf->size] = std::move(right->values[0]);
+      ++leaf->size;
+      for (size_type i = 1; i < right->size; ++i) {
+        right->keys[i - 1] = std::move(right->keys[i]);
+        right->values[i - 1] = std::move(right->values[i]);
+      }
+      --right->size;
+      parent->keys[index] = right->keys[0];
+    } else if (left != nullptr) {
+      merge_leaves(parent, index - 1);
+    } else {
+      merge_leaves(parent, index);
+    }
+  }
+  // Appends the leaf right of parent->keys[index] to the one left of it.
+  void merge_leaves(Inner* parent, size_type index) {
+    Leaf* left = static_cast<Leaf*>(parent->children[index]);
+    Leaf* right = static_cast<Leaf*>(parent->children[index + 1]);
+    for (size_type i = 0; i < right->size; ++i) {
+      left->keys[left->size + i] = std::move(right->keys[i]);
+      left->values[left->size + i] = std::move(right->values[i]);
+    }
+    left->size += right->size;
+    left->next = right->next;
+    remove_from_inner(parent, index);
+    delete_leaf(right);
+  }
+  void restore_inner(Inner* parent, size_type index) {
+    Inner* inner = static_cast<Inner*>(parent->children[index]);
+    Inner* left = index > 0 ?
+                  static_cast<Inner*>(parent->children[index - 1]) : nullptr;
+    Inner* right = index < parent->size ?
+                   static_cast<Inner*>(parent->children[index + 1]) : nullptr;
+    if (left != nullptr && left->size > min_keys) {
+      inner->children[inner->size + 1] = inner->children[inner->size];
+      for (size_type i = inner->size; i > 0; --i) {
+        inner->keys[i] = std::move(inner->keys[i - 1]);
+        inner->children[i] = inner->children[i - 1];
+      }
+      inner->keys[0] = std::move(parent->keys[index - 1]);
+      inner->children[0] = left->children[left->size];
+      ++inner->size;
+      parent->keys[index - 1] = std::move(left->keys[left->size - 1]);
+      --left->size;
+    } else if (right != nullptr && right->size > min_keys) {
+      inner->keys[inner->size] = std::move(parent->keys[index]);
+      inner->children[inner->size + 1] = right->children[0];
+      ++inner->size;
+      parent->keys[index] = std::move(right->keys[0]);
+      for (size_type i = 1; i < right->size; ++i) {
+        right->keys[i - 1] = std::move(right->keys[i]);
+        right->children[i - 1] = right->children[i];
+      }
+      right->children[right->size - 1] = right->children[right->size];
+      --right->size;
+    } else if (left != nullptr) {
+      merge_inners(parent, index - 1);
+    } else {
+      merge_inners(parent, index);
+    }
+  }
+  // Pulls parent->keys[index] down between the two children around it and
+  // appends the right child to the left one.
+  void merge_inners(Inner* parent, size_type index) {
+    Inner* left = static_cast<Inner*>(parent->children[index]);
+    Inner* right = static_cast<Inner*>(parent->children[index + 1]);
+    left->keys[left->size] = std::move(parent->keys[index]);
+    for (size_type i = 0; i < right->size; ++i) {
+      left->keys[left->size + 1 + i] = std::move(right->keys[i]);
+      left->children[left->size + 1 + i] = right->children[i];
+    }
+    left->children[left->size + 1 + right->size] =
+      right->children[right->size];
+    left->size += 1 + right->size;
+    remove_from_inner(parent, index);
+    delete_inner(right);
+  }
+  // Drops keys[index] and the child to its right.
+  void remove_from_inner(Inner* inner, size_type index) {
+    for (size_type i = index + 1; i < inner->size; ++i) {
+      inner->keys[i - 1] = std::move(inner->keys[i]);
+      inner->children[i] = inner->children[i + 1];
+    }
+    --inner->size;
+  }
+
+  // Copies the subtree of other at other_node level by level, chaining
+  // the new leaves through last_leaf.
+  Node* copy_node(const Node* other_node, size_type level, Leaf*& last_leaf) {
+    if (level == 0) {
+      const Leaf* other_leaf = static_cast<const Leaf*>(other_node);
+      Leaf* leaf = new_leaf();
+      std::copy(other_leaf->keys, other_leaf->keys + other_leaf->size,
+                leaf->keys);
+      std::copy(other_leaf->values, other_leaf->values + other_leaf->size,
+                leaf->values);
+      leaf->size = other_leaf->size;
+      if (last_leaf != nullptr) {
+        last_leaf->next = leaf;
+      }
+      last_leaf = leaf;
+      return leaf;
+    }
+    const Inner* other_inner = static_cast<const Inner*>(other_node);
+    Inner* inner = new_inner();
+    size_type copied = 0;
+    try {
+      for (; copied <= other_inner->size; ++copied) {
+        if (copied < other_inner->size) {
+          inner->keys[copied] = other_inner->keys[copied];
+        }
+        inner->children[copied] = copy_node(other_inner->children[copied],
+                                            level - 1, last_leaf);
+      }
+    } catch (...) {
+      for (size_type i = 0; i < copied; ++i) {
+        destroy(inner->children[i], level - 1);
+      }
+      delete_inner(inner);
+      throw;
+    }
+    inner->size = other_inner->size;
+    return inner;
+  }
+  void copy_from(const BPlusTree& other) {
+    if (other.root_ != nullptr) {
+      Leaf* last_leaf = nullptr;
+      root_ = copy_node(other.root_, other.height_, last_leaf);
+      height_ = other.height_;
+      size_ = other.size_;
+    }
+  }
+  void destroy(Node* node, size_type level) {
+    if (level == 0) {
+      delete_leaf(static_cast<Leaf*>(node));
+      return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    for (size_type i = 0; i <= inner->size; ++i) {
+      destroy(inner->children[i], level - 1);
+    }
+    delete_inner(inner);
+  }
+
+  Leaf* new_leaf() {
+    LeafAllocator alloc(alloc_);
+    Leaf* leaf = LeafTraits::allocate(alloc, 1);
+    try {
+      LeafTraits::construct(alloc, leaf);
+    } catch (...) {
+      LeafTraits::deallocate(alloc, leaf, 1);
+      throw;
+    }
+    return leaf;
+  }
+  void delete_leaf(Leaf* leaf) {
+    LeafAllocator alloc(alloc_);
+    LeafTraits::destroy(alloc, leaf);
+    LeafTraits::deallocate(alloc, leaf, 1);
+  }
+  Inner* new_inner() {
+    InnerAllocator alloc(alloc_);
+    Inner* inner = InnerTraits::allocate(alloc, 1);
+    try {
+      InnerTraits::construct(alloc, inner);
+    } catch (...) {
+      InnerTraits::deallocate(alloc, inner, 1);
+      throw;
+    }
+    return inner;
+  }
+  void delete_inner(Inner* inner) {
+    InnerAllocator alloc(alloc_);
+    InnerTraits::destroy(alloc, inner);
+    InnerTraits::deallocate(alloc, inner, 1);
+  }
+
+  size_type size_;
+  // Number of inner levels above the leaves; 0 when the root is a leaf.
+  size_type height_;
+  Node* root_;
+  Compare compare_;
+  Alloc alloc_;
+};
+
+#endif  // B_PLUS_TREE_H_
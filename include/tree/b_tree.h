@@ -23,28 +23,57 @@
 #ifndef B_TREE_H_
 #define B_TREE_H_
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <array>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tree/key_of_value.h"
+#include "tree/node_search.h"
 
 
 typedef std::size_t order_type;
 
-template <typename Tp, order_type order>
-class BTree {
+/*
+ * B-tree of values ordered by the key KeyOfValue takes from each value,
+ * with no two keys equal. BTree is the set over this base and BTreeMap
+ * (b_tree_map.h) the map.
+ */
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, order_type order, typename Alloc>
+class BTreeBase {
 public:
-  typedef Tp value_type;
-  typedef Tp& reference;
-  typedef const Tp& const_reference;
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Value& reference;
+  typedef const Value& const_reference;
   typedef std::size_t size_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
 
-  BTree() : size_(0), root_(nullptr) {}
-  BTree(const BTree& other) : size_(other.size_), root_(nullptr) {
+  BTreeBase() : size_(0), root_(nullptr) {}
+  explicit BTreeBase(const Alloc& alloc) :
+    size_(0), root_(nullptr), alloc_(alloc) {}
+  explicit BTreeBase(const Compare& compare, const Alloc& alloc = Alloc()) :
+    size_(0), root_(nullptr), compare_(compare), alloc_(alloc) {}
+  BTreeBase(const BTreeBase& other) :
+    size_(other.size_), root_(nullptr), compare_(other.compare_),
+    alloc_(std::allocator_traits<Alloc>::
+           select_on_container_copy_construction(other.alloc_)) {
     if (!other.empty()) {
       deep_copy(root_, other.root_);
     }
   }
-  BTree(BTree&& other) : size_(other.size_), root_(other.root_) {}
-  BTree& operator=(const BTree& rhs) {
+  BTreeBase(BTreeBase&& other) :
+    size_(other.size_), root_(std::move(other.root_)),
+    compare_(other.compare_), alloc_(other.alloc_) {
+    other.size_ = 0;
+  }
+  BTreeBase& operator=(const BTreeBase& rhs) {
     size_type new_size = rhs.size_;
     NodePtr new_root = nullptr;
     if (!rhs.empty()) {
@@ -53,46 +82,82 @@ public:
     clear();
     size_ = new_size;
     root_ = new_root;
+    compare_ = rhs.compare_;
     return *this;    
   }
-  BTree& operator=(BTree&& rhs) {
+  BTreeBase& operator=(BTreeBase&& rhs) {
     size_ = std::move(rhs.size_);
     root_ = std::move(rhs.root_);
+    compare_ = rhs.compare_;
+    rhs.size_ = 0;
     return *this;
   }
-  virtual ~BTree() {}
+  virtual ~BTreeBase() {}
 
-  bool empty() const { return size_ != 0; }
+  bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const { return alloc_; }
   void clear() {
     size_ = 0;
     root_ = nullptr;
   }
 
-  bool find(const value_type& value) {
-    return search(root_, value) != nullptr;
-  }
-  void insert(const value_type& value) {
-    value_type median;
-    NodePtr right_branch;
-    if (!push_down(root_, value, median, right_branch)) {
-      NodePtr new_root = std::make_shared<Node>();
-      new_root->size = 1;
-      new_root->data[0] = median;
-      new_root->branch[0] = root_;
-      new_root->branch[1] = right_branch;
-      root_ = new_root;
+  // Replaces the contents with [first, last), which must be sorted by key
+  // with no two keys equal, in linear time. The leaves are laid out first
+  // and every level above is built from the one below. Nodes are filled
+  // to about fill_factor of their order - 1 keys but never below the
+  // minimum a B-tree node holds; a lower fill leaves room for later
+  // insertions without splits.
+  template <typename ForwardIterator>
+  void build_from_sorted(ForwardIterator first, ForwardIterator last,
+                         double fill_factor = 1.0) {
+    size_type count = std::distance(first, last);
+    if (count == 0) {
+      clear();
+      return;
     }
-  }
-  void remove(const value_type& value) {
-    remove(root_, value);
-    if (root_ != nullptr && root_->size == 0) {
-      NodePtr old_root = root_;
-      root_ = root_->branch[0];
+    // Each leaf takes a run of the values as its keys and the value after
+    // the run separates it from the next leaf, so the leaves split count
+    // + 1 slots, one per key plus one per leaf, into near-equal parts.
+    size_type fill = fill_keys(fill_factor);
+    size_type leaves = part_count(count + 1, fill + 1);
+    std::vector<NodePtr> level(leaves);
+    std::vector<Value> separators(leaves - 1);
+    for (size_type i = 0; i < leaves; ++i) {
+      level[i] = build_leaf(first, part_size(count + 1, leaves, i) - 1);
+      if (i + 1 < leaves) {
+        separators[i] = *first;
+        ++first;
+      }
     }
+    root_ = build_levels(level, separators, fill);
+    size_ = count;
   }
-  void traverse(void (*func)(value_type&)) {
-    traverse(root_, func);
+  // As above, building the leaves in parallel on pool, a ForkJoinPool or
+  // anything with the same invoke and fork_join, in runs of about
+  // grain_size values. The levels above hold only one value per leaf and
+  // are built sequentially. Alloc must be safe to use from the pool's
+  // threads.
+  template <typename RandomAccessIterator, typename Pool>
+  void build_from_sorted(RandomAccessIterator first, RandomAccessIterator last,
+                         Pool& pool, double fill_factor = 1.0,
+                         size_type grain_size = 4096) {
+    size_type count = last - first;
+    if (count == 0) {
+      clear();
+      return;
+    }
+    size_type fill = fill_keys(fill_factor);
+    size_type leaves = part_count(count + 1, fill + 1);
+    std::vector<NodePtr> level(leaves);
+    std::vector<Value> separators(leaves - 1);
+    size_type grain_leaves = std::max<size_type>(grain_size / (fill + 1), 1);
+    pool.invoke([&]() {
+      build_leaves(first, count + 1, 0, leaves, level, separators, pool,
+                   grain_leaves);
+    });
+    root_ = build_levels(level, separators, fill);
+    size_ = count;
   }
 
 protected:
@@ -101,54 +166,209 @@ protected:
   struct Node {
     template <typename ListT, order_type ListN>
     using List = std::array<ListT, ListN>;
-    Node() : size(0), data(List<Tp, order - 1>()),
+    Node() : size(0), data(List<Value, order - 1>()),
              branch(List<NodePtr, order>()) {}
     size_type size;
-    List<Tp, order - 1> data;
+    List<Value, order - 1> data;
     List<NodePtr, order> branch;
   };
 
+  // Moves value into the tree unless its key is already present.
+  void insert_value(value_type& value) {
+    value_type median;
+    NodePtr right_branch;
+    if (!push_down(root_, value, median, right_branch)) {
+      NodePtr new_root = std::allocate_shared<Node>(alloc_);
+      new_root->size = 1;
+      new_root->data[0] = std::move(median);
+      new_root->branch[0] = root_;
+      new_root->branch[1] = right_branch;
+      root_ = new_root;
+    }
+  }
+  // Returns the value with an equal key, building and inserting it from
+  // args first if there is none. Values move between nodes as the tree
+  // changes, so the result is valid only until the next insertion or
+  // removal.
+  template <typename K, typename... Args>
+  std::pair<value_type*, bool> emplace_unique(const K& key, Args&&... args) {
+    size_type index;
+    NodePtr node = search(root_, key, index);
+    if (node != nullptr) {
+      return std::make_pair(&node->data[index], false);
+    }
+    value_type value(std::forward<Args>(args)...);
+    insert_value(value);
+    node = search(root_, key, index);
+    return std::make_pair(&node->data[index], true);
+  }
+  // Returns whether a value was removed.
+  template <typename K>
+  bool remove_key(const K& key) {
+    size_type old_size = size_;
+    remove(root_, key);
+    if (root_ != nullptr && root_->size == 0) {
+      NodePtr old_root = root_;
+      root_ = root_->branch[0];
+    }
+    return size_ != old_size;
+  }
+
+  // The number of keys per node that fill_factor asks for.
+  static size_type fill_keys(double fill_factor) {
+    fill_factor = std::min(std::max(fill_factor, 0.0), 1.0);
+    size_type keys = static_cast<size_type>(fill_factor * (order - 1) + 0.5);
+    return std::max<size_type>(keys, 1);
+  }
+  // The number of parts of about target each to cut total into, where
+  // every part must be at most order long and, when there are several, at
+  // least the minimum number of branches of a node.
+  static size_type part_count(size_type total, size_type target) {
+    size_type min_part = static_cast<size_type>((order - 1) / 2) + 1;
+    size_type count = (total + target - 1) / target;
+    count = std::min(count, std::max<size_type>(total / min_part, 1));
+    return std::max<size_type>(count, (total + order - 1) / order);
+  }
+  static size_type part_size(size_type total, size_type count,
+                             size_type index) {
+    return total / count + (index < total % count ? 1 : 0);
+  }
+  static size_type part_offset(size_type total, size_type count,
+                               size_type index) {
+    return index * (total / count) + std::min(index, total % count);
+  }
+  template <typename ForwardIterator>
+  NodePtr build_leaf(ForwardIterator& first, size_type size) {
+    NodePtr leaf = std::allocate_shared<Node>(alloc_);
+    for (size_type i = 0; i < size; ++i, ++first) {
+      leaf->data[i] = *first;
+    }
+    leaf->size = size;
+    return leaf;
+  }
+  template <typename RandomAccessIterator, typename Pool>
+  void build_leaves(RandomAccessIterator first, size_type total,
+                    size_type begin, size_type end,
+                    std::vector<NodePtr>& level,
+                    std::vector<Value>& separators, Pool& pool,
+                    size_type grain_leaves) {
+    if (end - begin <= grain_leaves) {
+      for (size_type i = begin; i < end; ++i) {
+        RandomAccessIterator iter =
+          first + part_offset(total, level.size(), i);
+        level[i] = build_leaf(iter, part_size(total, level.size(), i) - 1);
+        if (i + 1 < level.size()) {
+          separators[i] = *iter;
+        }
+      }
+      return;
+    }
+    size_type middle = begin + (end - begin) / 2;
+    pool.fork_join(
+      [&]() {
+        build_leaves(first, total, begin, middle, level, separators, pool,
+                     grain_leaves);
+      },
+      [&]() {
+        build_leaves(first, total, middle, end, level, separators, pool,
+                     grain_leaves);
+      });
+  }
+  // Builds the levels above level, where separators[i] lies between
+  // level[i] and level[i + 1], and returns the root. The separators
+  // between the groups of children of one node move up to the next level.
+  NodePtr build_levels(std::vector<NodePtr>& level,
+                       std::vector<Value>& separators, size_type fill) {
+    while (level.size() > 1) {
+      size_type count = level.size();
+      size_type parents = part_count(count, fill + 1);
+      std::vector<NodePtr> parent_level(parents);
+      std::vector<Value> parent_separators(parents - 1);
+      size_type child = 0;
+      for (size_type i = 0; i < parents; ++i) {
+        NodePtr node = std::allocate_shared<Node>(alloc_);
+        node->size = part_size(count, parents, i) - 1;
+        for (size_type j = 0; j <= node->size; ++j, ++child) {
+          node->branch[j] = std::move(level[child]);
+          if (j < node->size) {
+            node->data[j] = std::move(separators[child]);
+          }
+        }
+        if (i + 1 < parents) {
+          parent_separators[i] = std::move(separators[child - 1]);
+        }
+        parent_level[i] = std::move(node);
+      }
+      level.swap(parent_level);
+      separators.swap(parent_separators);
+    }
+    return level[0];
+  }
   void deep_copy(NodePtr& copy_ptr, const NodePtr& other_ptr) {
     if (other_ptr != nullptr) {
-      copy_ptr = std::make_shared<Node>(other_ptr->value);
-      deep_copy(copy_ptr->left, other_ptr->left);
-      deep_copy(copy_ptr->right, other_ptr->right);
-    }    
-  }  
-  NodePtr search(const NodePtr& sub_root, const value_type& value, 
-                 size_type& index) {
+      copy_ptr = std::allocate_shared<Node>(alloc_);
+      copy_ptr->size = other_ptr->size;
+      copy_ptr->data = other_ptr->data;
+      for (size_type i = 0; i <= other_ptr->size; ++i) {
+        deep_copy(copy_ptr->branch[i], other_ptr->branch[i]);
+      }
+    }
+  }
+  const Key& key_of(const Value& value) const {
+    return KeyOfValue()(value);
+  }
+  // Accepts any type that compare_ can order against the keys.
+  template <typename K>
+  NodePtr search(const NodePtr& sub_root, const K& key, 
+                 size_type& index) const {
     if (sub_root == nullptr) {
       return nullptr;
     }
-    if (is_in_node(sub_root, value, index)) {
+    if (is_in_node(sub_root, key, index)) {
       return sub_root;
     } else {
-      return search(sub_root->branch[index], value, index);
+      return search(sub_root->branch[index], key, index);
     }
   }
-  NodePtr search(const NodePtr& sub_root, const value_type& value) {
+  template <typename K>
+  NodePtr search(const NodePtr& sub_root, const K& key) const {
     size_type dummy;
-    return search(sub_root, value, dummy);
+    return search(sub_root, key, dummy);
   }
-  bool is_in_node(const NodePtr& current_node, const value_type& value, 
-                  size_type& index) {
-    size_type pos = 0;
-    while (pos < current_node->size && current_node->data[pos] < value) {
-      ++pos;
-    }
-    index = pos;
-    return pos < current_node->size && current_node->data[pos] == value;
+  template <typename K>
+  bool is_in_node(const NodePtr& current_node, const K& key, 
+                  size_type& index) const {
+    index = lower_index(current_node, key, std::integral_constant<bool,
+      std::is_same<Value, Key>::value && std::is_same<K, Key>::value &&
+      std::is_same<Compare, std::less<Key>>::value>());
+    return index < current_node->size &&
+           !compare_(key, key_of(current_node->data[index]));
+  }
+  // Sets of keys ordered by < are searched with NodeSearch.
+  size_type lower_index(const NodePtr& current_node, const Key& key,
+                        std::true_type) const {
+    return NodeSearch<Key>::lower_bound(current_node->data.data(),
+                                        current_node->size, key);
+  }
+  template <typename K>
+  size_type lower_index(const NodePtr& current_node, const K& key,
+                        std::false_type) const {
+    const Value* data = current_node->data.data();
+    return std::lower_bound(data, data + current_node->size, key,
+                            [this](const Value& value, const K& x) {
+                              return compare_(key_of(value), x);
+                            }) - data;
   }
-  bool push_down(NodePtr& current_node, const value_type& value, 
+  bool push_down(NodePtr& current_node, value_type& value, 
                  value_type& median, NodePtr& right_branch) {
     if (current_node == nullptr) {
-      median = value;
+      median = std::move(value);
       right_branch = nullptr;
       ++size_;
       return false;
     } else {
       size_type index;
-      if (is_in_node(current_node, value, index)) {
+      if (is_in_node(current_node, key_of(value), index)) {
         return true;
       } else {
         value_type extra_value;
@@ -169,25 +389,25 @@ protected:
       }
     }
   }
-  void push_in(NodePtr& current_node, const value_type& value, 
+  void push_in(NodePtr& current_node, value_type& value, 
                const NodePtr& right_branch, const size_type& index) {
     for (size_type i = current_node->size; i > index; --i) {
-      current_node->data[i] = current_node->data[i - 1];
+      current_node->data[i] = std::move(current_node->data[i - 1]);
       current_node->branch[i + 1] = current_node->branch[i];
     }
-    current_node->data[index] = value;
+    current_node->data[index] = std::move(value);
     current_node->branch[index + 1] = right_branch;
     ++current_node->size;
   }
-  void split_node(NodePtr& current_node, const value_type& extra_value,
+  void split_node(NodePtr& current_node, value_type& extra_value,
                   NodePtr& extra_branch, const size_type& index, 
                   value_type& median, NodePtr& right_branch) {
-    right_branch = std::make_shared<Node>();
+    right_branch = std::allocate_shared<Node>(alloc_);
     size_type middle = static_cast<size_type>(order / 2);
     bool index_le_middle = (index <= middle);
     middle = index_le_middle ? middle : middle + 1;
     for (size_type i = middle; i < order - 1; ++i) {
-      right_branch->data[i - middle] = current_node->data[i];
+      right_branch->data[i - middle] = std::move(current_node->data[i]);
       right_branch->branch[i + 1 - middle] = current_node->branch[i + 1];
     }
     current_node->size = middle;
@@ -197,25 +417,27 @@ protected:
     } else {
       push_in(right_branch, extra_value, extra_branch, index - middle);
     }
-    median = current_node->data[current_node->size - 1];
+    median = std::move(current_node->data[current_node->size - 1]);
     right_branch->branch[0] = current_node->branch[current_node->size];
     --current_node->size;
   }
-  void remove(NodePtr& current_node, const value_type& value) {
+  template <typename K>
+  void remove(NodePtr& current_node, const K& key) {
     if (current_node == nullptr) {
       return;
     }
     size_type index;
-    if (is_in_node(current_node, value, index)) {
+    if (is_in_node(current_node, key, index)) {
       if (current_node->branch[index] != nullptr) {
         copy_from_predecessor(current_node, index);
-        remove(current_node->branch[index], current_node->data[index]);
+        remove(current_node->branch[index],
+               key_of(current_node->data[index]));
       } else {
         remove_data(current_node, index);
         --size_;
       }
     } else {
-      remove(current_node->branch[index], value);
+      remove(current_node->branch[index], key);
     }
     if (current_node->branch[index] != nullptr && 
         current_node->branch[index]->size < 
@@ -281,15 +503,15 @@ protected:
   void move_right_from_branch(NodePtr& current_node, const size_type& index) {
     NodePtr to_branch = current_node->branch[index + 1],
             from_branch = current_node->branch[index];
-    for (size_type i = to_branch->size - 1; i >= 0; --i) {
-      to_branch->data[i + 1] = to_branch->data[i];
+    for (size_type i = to_branch->size; i > 0; --i) {
+      to_branch->data[i] = to_branch->data[i - 1];
     }
-    for (size_type i = to_branch->size; i >= 0; --i) {
-      to_branch->branch[i + 1] = to_branch->branch[i];
+    for (size_type i = to_branch->size + 1; i > 0; --i) {
+      to_branch->branch[i] = to_branch->branch[i - 1];
     }
     ++to_branch->size;
     to_branch->data[0] = current_node->data[index];
-    current_node->data[index] = from_branch->data[from_branch->size];
+    current_node->data[index] = from_branch->data[from_branch->size - 1];
     to_branch->branch[0] = from_branch->branch[from_branch->size];
     --from_branch->size;
   }
@@ -321,9 +543,51 @@ protected:
       }
     }
   }
+  template <typename Function>
+  void inorder(NodePtr& current_node, Function& func) {
+    if (current_node != nullptr) {
+      for (size_type i = 0; i < current_node->size; ++i) {
+        inorder(current_node->branch[i], func);
+        func(current_node->data[i]);
+      }
+      inorder(current_node->branch[current_node->size], func);
+    }
+  }
 
   size_type size_;
   NodePtr root_;
+  Compare compare_;
+  Alloc alloc_;
+};
+
+template <typename Tp, order_type order,
+          typename Alloc = std::allocator<Tp>>
+class BTree :
+  public BTreeBase<Tp, Tp, IdentityKey<Tp>, std::less<Tp>, order, Alloc> {
+public:
+  typedef Tp value_type;
+  typedef std::size_t size_type;
+
+  BTree() {}
+  explicit BTree(const Alloc& alloc) : Base(alloc) {}
+
+  bool find(const value_type& value) {
+    return this->search(this->root_, value) != nullptr;
+  }
+  void insert(const value_type& value) {
+    value_type copy(value);
+    this->insert_value(copy);
+  }
+  void remove(const value_type& value) {
+    this->remove_key(value);
+  }
+  void traverse(void (*func)(value_type&)) {
+    Base::traverse(this->root_, func);
+  }
+
+protected:
+  typedef BTreeBase<Tp, Tp, IdentityKey<Tp>, std::less<Tp>, order, Alloc>
+    Base;
 };
 
 #endif  // B_TREE_H_
\ No newline at end of file
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef B_TREE_MAP_H_
+#define B_TREE_MAP_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "tree/b_tree.h"
+#include "tree/key_of_value.h"
+
+/*
+ * Map from Key to Tp on a B-tree, with the interface of RBMap. Entries are
+ * stored by value in the nodes and shift as nodes fill, split and merge,
+ * so unlike in RBMap a pointer returned by find or an insertion is valid
+ * only until the next insertion or removal. Keys are therefore stored
+ * mutable, but are never handed out for modification.
+ */
+template <typename Key, typename Tp, order_type order,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<std::pair<Key, Tp>>>
+class BTreeMap :
+  public BTreeBase<Key, std::pair<Key, Tp>, FirstKey<std::pair<Key, Tp>>,
+                   Compare, order, Alloc> {
+protected:
+  typedef BTreeBase<Key, std::pair<Key, Tp>, FirstKey<std::pair<Key, Tp>>,
+                    Compare, order, Alloc> Base;
+  typedef typename Base::NodePtr NodePtr;
+
+  // Admits lookups by types other than Key only with a transparent Compare.
+  template <typename K>
+  using EnableIfTransparent =
+    typename std::enable_if<IsTransparent<Compare>::value, K>::type;
+
+public:
+  typedef Key key_type;
+  typedef Tp mapped_type;
+  typedef std::pair<Key, Tp> value_type;
+  typedef std::size_t size_type;
+
+  BTreeMap() {}
+  explicit BTreeMap(const Compare& compare, const Alloc& alloc = Alloc()) :
+    Base(compare, alloc) {}
+  explicit BTreeMap(const Alloc& alloc) : Base(alloc) {}
+
+  Tp* find(const Key& key) { return find_mapped(key); }
+  const Tp* find(const Key& key) const { return find_mapped(key); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  Tp* find(const K& key) { return find_mapped(key); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  const Tp* find(const K& key) const { return find_mapped(key); }
+  bool contains(const Key& key) const {
+    return this->search(this->root_, key) != nullptr;
+  }
+  template <typename K, typename = EnableIfTransparent<K>>
+  bool contains(const K& key) const {
+    return this->search(this->root_, key) != nullptr;
+  }
+  Tp& at(const Key& key) {
+    return const_cast<Tp&>(static_cast<const BTreeMap&>(*this).at(key));
+  }
+  const Tp& at(const Key& key) const {
+    const Tp* value = find(key);
+    if (value == nullptr) {
+      throw std::out_of_range(
+        "BTreeMap::at() is undefined for a key that is not in the map.");
+    }
+    return *value;
+  }
+  Tp& operator[](const Key& key) { return *try_emplace(key).first; }
+  Tp& operator[](Key&& key) { return *try_emplace(std::move(key)).first; }
+
+  std::pair<Tp*, bool> insert(const value_type& value) {
+    return mapped(this->emplace_unique(value.first, value));
+  }
+  // The entry is looked up again once it has settled into its node, so
+  // a moved key is first copied for that lookup.
+  std::pair<Tp*, bool> insert(value_type&& value) {
+    Key key(value.first);
+    return mapped(this->emplace_unique(key, std::move(value)));
+  }
+  template <typename... Args>
+  std::pair<Tp*, bool> try_emplace(const Key& key, Args&&... args) {
+    return mapped(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(key),
+      std::forward_as_tuple(std::forward<Args>(args)...)));
+  }
+  template <typename... Args>
+  std::pair<Tp*, bool> try_emplace(Key&& key, Args&&... args) {
+    if (Tp* value = find_mapped(key)) {
+      return std::make_pair(value, false);
+    }
+    Key lookup_key(key);
+    return mapped(this->emplace_unique(
+      lookup_key, std::piecewise_construct,
+      std::forward_as_tuple(std::move(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...)));
+  }
+  template <typename Mapped>
+  std::pair<Tp*, bool> insert_or_assign(const Key& key, Mapped&& value) {
+    std::pair<Tp*, bool> result = try_emplace(key,
+                                              std::forward<Mapped>(value));
+    if (!result.second) {
+      *result.first = std::forward<Mapped>(value);
+    }
+    return result;
+  }
+  template <typename Mapped>
+  std::pair<Tp*, bool> insert_or_assign(Key&& key, Mapped&& value) {
+    std::pair<Tp*, bool> result = try_emplace(std::move(key),
+                                              std::forward<Mapped>(value));
+    if (!result.second) {
+      *result.first = std::forward<Mapped>(value);
+    }
+    return result;
+  }
+
+  // Returns whether an entry was removed.
+  bool remove(const Key& key) { return this->remove_key(key); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  bool remove(const K& key) { return this->remove_key(key); }
+
+  // Calls func(key, mapped value) in key order.
+  template <typename Function>
+  void traverse(Function func) {
+    auto visit = [&func](value_type& value) {
+      func(static_cast<const Key&>(value.first), value.second);
+    };
+    this->inorder(this->root_, visit);
+  }
+
+protected:
+  template <typename K>
+  Tp* find_mapped(const K& key) const {
+    size_type index;
+    NodePtr node = this->search(this->root_, key, index);
+    return node == nullptr ? nullptr : &node->data[index].second;
+  }
+  static std::pair<Tp*, bool> mapped(
+    const std::pair<value_type*, bool>& result) {
+    return std::make_pair(&result.first->second, result.second);
+  }
+};
+
+#endif  // B_TREE_MAP_H_
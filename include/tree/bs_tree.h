@@ -24,22 +24,31 @@
 
 #include <memory>
 
-template <typename Tp>
+#include "tree/release_tree.h"
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
 class BSTree {
 public:
   typedef Tp value_type;
   typedef Tp& reference;
   typedef const Tp& const_reference;
   typedef std::size_t size_type;
+  typedef Alloc allocator_type;
 
   BSTree() : size_(0), root_ptr_(nullptr) {}
-  BSTree(const BSTree& other) : size_(other.size_), root_ptr_(nullptr) {
+  explicit BSTree(const Alloc& alloc) :
+    size_(0), root_ptr_(nullptr), alloc_(alloc) {}
+  BSTree(const BSTree& other) :
+    size_(other.size_), root_ptr_(nullptr),
+    alloc_(std::allocator_traits<Alloc>::
+          select_on_container_copy_construction(other.alloc_)) {
     if (!other.empty()) {
       deep_copy(root_ptr_, other.root_ptr_);
     }
   }
   BSTree(BSTree&& other) : 
-    size_(std::move(other.size_)), root_ptr_(std::move(other.root_ptr_)) {}
+    size_(std::move(other.size_)), root_ptr_(std::move(other.root_ptr_)),
+    alloc_(other.alloc_) {}
   BSTree& operator=(const BSTree& rhs) {
     size_type new_size = rhs.size_;
     NodePtr new_root_ptr = nullptr;
@@ -52,17 +61,19 @@ public:
     return *this;
   }
   BSTree& operator=(BSTree&& rhs) {
+    clear();
     size_ = std::move(rhs.size_);
     root_ptr_ = std::move(rhs.root_ptr_);
     return *this;
   }
-  virtual ~BSTree() {}
+  virtual ~BSTree() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const { return alloc_; }
   void clear() {
+    release_tree(std::move(root_ptr_), &Node::left, &Node::right);
     size_ = 0;
-    root_ptr_ = nullptr;
   }
 
   bool find(const value_type& value) const {
@@ -106,7 +117,7 @@ protected:
 
   void deep_copy(NodePtr& copy_ptr, const NodePtr& other_ptr) {
     if (other_ptr != nullptr) {
-      copy_ptr = std::make_shared<Node>(other_ptr->value);
+      copy_ptr = std::allocate_shared<Node>(alloc_, other_ptr->value);
       deep_copy(copy_ptr->left, other_ptr->left);
       deep_copy(copy_ptr->right, other_ptr->right);
     }
@@ -125,7 +136,7 @@ protected:
   }
   void insert(NodePtr& sub_root_ptr, const value_type& value) {
     if (sub_root_ptr == nullptr) {
-      sub_root_ptr = std::make_shared<Node>(value);
+      sub_root_ptr = std::allocate_shared<Node>(alloc_, value);
       ++size_;
     } else if (sub_root_ptr->value > value) {
       insert(sub_root_ptr->left, value);
@@ -192,6 +203,7 @@ protected:
 
   size_type size_;
   NodePtr root_ptr_;
+  Alloc alloc_;
 };
 
 #endif  // BS_TREE_H_
\ No newline at end of file
@@ -24,22 +24,31 @@
 
 #include <memory>
 
-template <typename Tp>
+#include "tree/release_tree.h"
+
+template <typename Tp, typename Alloc = std::allocator<Tp>>
 class BSTree {
 public:
   typedef Tp value_type;
   typedef Tp& reference;
   typedef const Tp& const_reference;
   typedef std::size_t size_type;
+  typedef Alloc allocator_type;
 
   BSTree() : size_(0), root_ptr_(nullptr) {}
-  BSTree(const BSTree& other) : size_(other.size_), root_ptr_(nullptr) {
+  explicit BSTree(const Alloc& alloc) :
+    size_(0), root_ptr_(nullptr), alloc_(alloc) {}
+  BSTree(const BSTree& other) :
+    size_(other.size_), root_ptr_(nullptr),
+    alloc_(std::allocator_traits<Alloc>::
+          select_on_container_copy_construction(other.alloc_)) {
     if (!other.empty()) {
       deep_copy(nullptr, root_ptr_, other.root_ptr_);
     }
   }
   BSTree(BSTree&& other) : 
-    size_(std::move(other.size_)), root_ptr_(std::move(other.root_ptr_)) {}
+    size_(std::move(other.size_)), root_ptr_(std::move(other.root_ptr_)),
+    alloc_(other.alloc_) {}
   BSTree& operator=(const BSTree& rhs) {
     size_type new_size = rhs.size_;
     NodePtr new_root_ptr = nullptr;
@@ -52,17 +61,20 @@ public:
     return *this;
   }
   BSTree& operator=(BSTree&& rhs) {
+    clear();
     size_ = std::move(rhs.size_);
     root_ptr_ = std::move(rhs.root_ptr_);
     return *this;
   }
-  virtual ~BSTree() {}
+  virtual ~BSTree() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
+  allocator_type get_allocator() const { return alloc_; }
   void clear() {
+    // The parent links are weak and need no special care.
+    release_tree(std::move(root_ptr_), &Node::lchild, &Node::rchild);
     size_ = 0;
-    root_ptr_ = nullptr;
   }
 
   bool find(const value_type& value) const {
@@ -120,7 +132,7 @@ protected:
   void deep_copy(const NodePtr& parent_ptr, NodePtr& copy_ptr, 
                  const NodePtr& other_ptr) {
     if (other_ptr != nullptr) {
-      copy_ptr = std::make_shared<Node>(other_ptr->value);
+      copy_ptr = std::allocate_shared<Node>(alloc_, other_ptr->value);
       copy_ptr->parent = parent_ptr;
       deep_copy(copy_ptr, copy_ptr->lchild, other_ptr->lchild);
       deep_copy(copy_ptr, copy_ptr->rchild, other_ptr->rchild);
@@ -149,7 +161,7 @@ protected:
         return;
       }
     }
-    NodePtr new_ptr = std::make_shared<Node>(value);
+    NodePtr new_ptr = std::allocate_shared<Node>(alloc_, value);
     if (parent_ptr == nullptr) {
       root_ptr_ = new_ptr;
     } else if (parent_ptr->value > value) {
@@ -263,6 +275,7 @@ protected:
 
   size_type size_;
   NodePtr root_ptr_;
+  Alloc alloc_;
 };
 
 #endif  // BS_TREE_H_
\ No newline at end of file
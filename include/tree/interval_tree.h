@@ -0,0 +1,122 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef INTERVAL_TREE_H_
+#define INTERVAL_TREE_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "tree/augment.h"
+#include "tree/key_of_value.h"
+#include "tree/rb_tree.h"
+
+/*
+ * Closed intervals [low, high] on a red-black tree ordered by low and then
+ * high endpoint, every node augmented with the greatest high endpoint in
+ * its subtree. A search for the intervals overlapping a query skips every
+ * subtree whose greatest high endpoint falls short of it and stops at the
+ * first low endpoint past it, so it takes O(log n + k log(n / k)) time for
+ * k results. The same interval may be stored more than once.
+ */
+template <typename Tp, typename Alloc = std::allocator<std::pair<Tp, Tp>>>
+class IntervalTree :
+  public RBTreeBase<std::pair<Tp, Tp>, std::pair<Tp, Tp>,
+                    IdentityKey<std::pair<Tp, Tp>>,
+                    std::less<std::pair<Tp, Tp>>, Alloc,
+                    MaxAugment<std::pair<Tp, Tp>,
+                               MappedValue<std::pair<Tp, Tp>>>> {
+protected:
+  typedef RBTreeBase<std::pair<Tp, Tp>, std::pair<Tp, Tp>,
+                     IdentityKey<std::pair<Tp, Tp>>,
+                     std::less<std::pair<Tp, Tp>>, Alloc,
+                     MaxAugment<std::pair<Tp, Tp>,
+                                MappedValue<std::pair<Tp, Tp>>>> Base;
+  typedef typename Base::Node Node;
+  typedef typename Base::NodePtr NodePtr;
+
+public:
+  typedef std::pair<Tp, Tp> value_type;
+  typedef std::size_t size_type;
+
+  IntervalTree() {}
+  explicit IntervalTree(const Alloc& alloc) : Base(alloc) {}
+
+  void insert(const Tp& low, const Tp& high) {
+    if (high < low) {
+      throw std::out_of_range(
+        "IntervalTree::insert() is undefined when high is less than low.");
+    }
+    NodePtr insert_node = std::allocate_shared<Node>(this->alloc_, low, high);
+    Base::insert(this->root_, insert_node);
+    ++this->size_;
+  }
+  // Removes one copy of [low, high] and returns whether there was one.
+  bool remove(const Tp& low, const Tp& high) {
+    NodePtr remove_node = this->search(value_type(low, high));
+    if (remove_node == nullptr) {
+      return false;
+    }
+    Base::remove(this->root_, remove_node);
+    --this->size_;
+    return true;
+  }
+  bool contains(const Tp& low, const Tp& high) const {
+    return this->search(value_type(low, high)) != nullptr;
+  }
+
+  // Calls func(low, high) for every interval sharing a point with
+  // [low, high], in order.
+  template <typename Function>
+  void overlapping(const Tp& low, const Tp& high, Function func) const {
+    overlapping(this->root_.get(), low, high, func);
+  }
+  std::vector<value_type> overlapping(const Tp& low, const Tp& high) const {
+    std::vector<value_type> result;
+    overlapping(low, high, [&result](const Tp& first, const Tp& last) {
+      result.push_back(value_type(first, last));
+    });
+    return result;
+  }
+
+protected:
+  template <typename Function>
+  static void overlapping(const Node* node, const Tp& low, const Tp& high,
+                          Function& func) {
+    if (node == nullptr || node->summary() < low) {
+      return;
+    }
+    overlapping(node->left.get(), low, high, func);
+    if (high < node->value.first) {
+      return;
+    }
+    if (!(node->value.second < low)) {
+      func(node->value.first, node->value.second);
+    }
+    overlapping(node->right.get(), low, high, func);
+  }
+};
+
+#endif  // INTERVAL_TREE_H_
@@ -0,0 +1,556 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef INTRUSIVE_RB_TREE_H_
+#define INTRUSIVE_RB_TREE_H_
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Links embedded in an object so that it can be put in an IntrusiveRBTree.
+// Copying an object does not copy its membership.
+struct IntrusiveRBTreeHook {
+  enum Color { red, black };
+
+  IntrusiveRBTreeHook() :
+    parent(nullptr), left(nullptr), right(nullptr), color(black),
+    linked(false) {}
+  IntrusiveRBTreeHook(const IntrusiveRBTreeHook&) :
+    parent(nullptr), left(nullptr), right(nullptr), color(black),
+    linked(false) {}
+  IntrusiveRBTreeHook& operator=(const IntrusiveRBTreeHook&) {
+    return *this;
+  }
+
+  bool is_linked() const { return linked; }
+
+  IntrusiveRBTreeHook* parent;
+  IntrusiveRBTreeHook* left;
+  IntrusiveRBTreeHook* right;
+  Color color;
+  bool linked;
+};
+
+/*
+ * Red-black tree of objects that carry their own links, ordered by
+ * Compare on the objects themselves. Equivalent objects are kept in
+ * insertion order. The tree neither allocates nor owns anything, and
+ * erase(object) unlinks an object in O(log n) without searching for it.
+ *
+ * An object must be erased before it is destroyed, must not change its
+ * ordering while linked, and may be in only one tree per hook.
+ */
+template <typename Tp, IntrusiveRBTreeHook Tp::*hook,
+          typename Compare = std::less<Tp>>
+class IntrusiveRBTree {
+protected:
+  typedef IntrusiveRBTreeHook Hook;
+  template <typename Reference, typename Pointer>
+  class Iterator;
+
+public:
+  typedef Tp value_type;
+  typedef Tp& reference;
+  typedef const Tp& const_reference;
+  typedef std::size_t size_type;
+  typedef Compare value_compare;
+  typedef Iterator<Tp&, Tp*> iterator;
+  typedef Iterator<const Tp&, const Tp*> const_iterator;
+
+  explicit IntrusiveRBTree(const Compare& compare = Compare()) :
+    size_(0), root_(nullptr), compare_(compare) {}
+  IntrusiveRBTree(const IntrusiveRBTree&) = delete;
+  IntrusiveRBTree(IntrusiveRBTree&& other) :
+    size_(0), root_(nullptr), compare_(other.compare_) {
+    swap(other);
+  }
+  IntrusiveRBTree& operator=(const IntrusiveRBTree&) = delete;
+  IntrusiveRBTree& operator=(IntrusiveRBTree&& rhs) {
+    clear();
+    swap(rhs);
+    return *this;
+  }
+  virtual ~IntrusiveRBTree() { clear(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  // Unlinks every object, leaves first; none is destroyed.
+  void clear() {
+    Hook* node = root_;
+    while (node != nullptr) {
+      if (node->left != nullptr) {
+        node = node->left;
+      } else if (node->right != nullptr) {
+        node = node->right;
+      } else {
+        Hook* parent = node->parent;
+        if (parent != nullptr) {
+          if (parent->left == node) {
+            parent->left = nullptr;
+          } else {
+            parent->right = nullptr;
+          }
+        }
+        reset(node);
+        node = parent;
+      }
+    }
+    size_ = 0;
+    root_ = nullptr;
+  }
+  void swap(IntrusiveRBTree& other) {
+    std::swap(size_, other.size_);
+    std::swap(root_, other.root_);
+    std::swap(compare_, other.compare_);
+  }
+
+  iterator begin() { return iterator(min(root_), this); }
+  const_iterator begin() const { return const_iterator(min(root_), this); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(nullptr, this); }
+  const_iterator end() const { return const_iterator(nullptr, this); }
+  const_iterator cend() const { return end(); }
+  iterator iterator_to(reference object) {
+    return iterator(&(object.*hook), this);
+  }
+  const_iterator iterator_to(const_reference object) const {
+    return const_iterator(&(object.*hook), this);
+  }
+
+  reference front() {
+    require_nonempty("IntrusiveRBTree::front()");
+    return *to_object(min(root_));
+  }
+  const_reference front() const {
+    require_nonempty("IntrusiveRBTree::front()");
+    return *to_object(min(root_));
+  }
+  reference back() {
+    require_nonempty("IntrusiveRBTree::back()");
+    return *to_object(max(root_));
+  }
+  const_reference back() const {
+    require_nonempty("IntrusiveRBTree::back()");
+    return *to_object(max(root_));
+  }
+  void pop_front() {
+    require_nonempty("IntrusiveRBTree::pop_front()");
+    remove(min(root_));
+  }
+
+  // Links object after any equivalent objects already in the tree.
+  iterator insert(reference object) {
+    Hook* insert_node = &(object.*hook);
+    Hook* iter_parent = nullptr;
+    Hook* iter_node = root_;
+    bool go_left = false;
+    while (iter_node != nullptr) {
+      iter_parent = iter_node;
+      go_left = compare_(object, *to_object(iter_node));
+      iter_node = go_left ? iter_node->left : iter_node->right;
+    }
+    insert_node->parent = iter_parent;
+    insert_node->left = nullptr;
+    insert_node->right = nullptr;
+    insert_node->color = Hook::red;
+    insert_node->linked = true;
+    if (iter_parent == nullptr) {
+      root_ = insert_node;
+    } else if (go_left) {
+      iter_parent->left = insert_node;
+    } else {
+      iter_parent->right = insert_node;
+    }
+    insert_fix_up(insert_node);
+    ++size_;
+    return iterator(insert_node, this);
+  }
+  // Unlinks object, which must be in this tree.
+  void erase(reference object) { remove(&(object.*hook)); }
+  // Unlinks the object at position and returns the position after it.
+  iterator erase(const_iterator position) {
+    Hook* next = successor(position.node_);
+    remove(position.node_);
+    return iterator(next, this);
+  }
+
+  // The first object equivalent to value, or end().
+  iterator find(const value_type& value) {
+    iterator position = lower_bound(value);
+    return position != end() && !compare_(value, *position) ?
+           position : end();
+  }
+  const_iterator find(const value_type& value) const {
+    const_iterator position = lower_bound(value);
+    return position != end() && !compare_(value, *position) ?
+           position : end();
+  }
+  iterator lower_bound(const value_type& value) {
+    return iterator(lower_bound_node(value), this);
+  }
+  const_iterator lower_bound(const value_type& value) const {
+    return const_iterator(lower_bound_node(value), this);
+  }
+  iterator upper_bound(const value_type& value) {
+    return iterator(upper_bound_node(value), this);
+  }
+  const_iterator upper_bound(const value_type& value) const {
+    return const_iterator(upper_bound_node(value), this);
+  }
+
+  template <typename Function>
+  void inorder(Function func) {
+    for (Hook* node = min(root_); node != nullptr; node = successor(node)) {
+      func(*to_object(node));
+    }
+  }
+  template <typename Function>
+  void inorder(Function func) const {
+    for (Hook* node = min(root_); node != nullptr; node = successor(node)) {
+      func(*static_cast<const Tp*>(to_object(node)));
+    }
+  }
+
+protected:
+  template <typename Reference, typename Pointer>
+  class Iterator {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Tp value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Pointer pointer;
+    typedef Reference reference;
+
+    Iterator() : node_(nullptr), tree_(nullptr) {}
+    // Allows iterator to const_iterator conversion, but not the reverse.
+    template <typename OtherReference, typename OtherPointer,
+              typename = typename std::enable_if<
+                std::is_convertible<OtherPointer, Pointer>::value>::type>
+    Iterator(const Iterator<OtherReference, OtherPointer>& other) :
+      node_(other.node_), tree_(other.tree_) {}
+
+    reference operator*() const { return *to_object(node_); }
+    pointer operator->() const { return to_object(node_); }
+    Iterator& operator++() {
+      node_ = successor(node_);
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    // Decrementing end() yields the last object.
+    Iterator& operator--() {
+      node_ = node_ == nullptr ? max(tree_->root_) : predecessor(node_);
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator old = *this;
+      --*this;
+      return old;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator==(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ == rhs.node_;
+    }
+    template <typename OtherReference, typename OtherPointer>
+    bool operator!=(const Iterator<OtherReference, OtherPointer>& rhs) const {
+      return node_ != rhs.node_;
+    }
+
+  private:
+    friend class IntrusiveRBTree;
+    template <typename, typename> friend class Iterator;
+    Iterator(const Hook* node, const IntrusiveRBTree* tree) :
+      node_(const_cast<Hook*>(node)), tree_(tree) {}
+    Hook* node_;
+    const IntrusiveRBTree* tree_;
+  };
+
+  // Offset of the hook inside Tp, measured on raw storage so that no Tp
+  // is constructed; the compiler folds it to a constant.
+  static std::ptrdiff_t hook_offset() {
+    typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type storage;
+    const Tp* object = reinterpret_cast<const Tp*>(&storage);
+    return reinterpret_cast<const char*>(&(object->*hook)) -
+           reinterpret_cast<const char*>(object);
+  }
+  static Tp* to_object(const Hook* node) {
+    return reinterpret_cast<Tp*>(
+      const_cast<char*>(reinterpret_cast<const char*>(node)) - hook_offset());
+  }
+  static void reset(Hook* node) {
+    node->parent = nullptr;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->color = Hook::black;
+    node->linked = false;
+  }
+  static bool is_black(const Hook* node) {
+    return node == nullptr || node->color == Hook::black;
+  }
+
+  static Hook* min(Hook* sub_root) {
+    if (sub_root != nullptr) {
+      while (sub_root->left != nullptr) {
+        sub_root = sub_root->left;
+      }
+    }
+    return sub_root;
+  }
+  static Hook* max(Hook* sub_root) {
+    if (sub_root != nullptr) {
+      while (sub_root->right != nullptr) {
+        sub_root = sub_root->right;
+      }
+    }
+    return sub_root;
+  }
+  static Hook* successor(Hook* node) {
+    if (node->right != nullptr) {
+      return min(node->right);
+    }
+    while (node->parent != nullptr && node->parent->right == node) {
+      node = node->parent;
+    }
+    return node->parent;
+  }
+  static Hook* predecessor(Hook* node) {
+    if (node->left != nullptr) {
+      return max(node->left);
+    }
+    while (node->parent != nullptr && node->parent->left == node) {
+      node = node->parent;
+    }
+    return node->parent;
+  }
+  Hook* lower_bound_node(const value_type& value) const {
+    Hook* result = nullptr;
+    Hook* node = root_;
+    while (node != nullptr) {
+      if (compare_(*to_object(node), value)) {
+        node = node->right;
+      } else {
+        result = node;
+        node = node->left;
+      }
+    }
+    return result;
+  }
+  Hook* upper_bound_node(const value_type& value) const {
+    Hook* result = nullptr;
+    Hook* node = root_;
+    while (node != nullptr) {
+      if (compare_(value, *to_object(node))) {
+        result = node;
+        node = node->left;
+      } else {
+        node = node->right;
+      }
+    }
+    return result;
+  }
+
+  // Puts child where node was under node's parent.
+  void replace_child(Hook* node, Hook* child) {
+    if (node->parent == nullptr) {
+      root_ = child;
+    } else if (node->parent->left == node) {
+      node->parent->left = child;
+    } else {
+      node->parent->right = child;
+    }
+  }
+  void rotate_left(Hook* node) {
+    Hook* rchild = node->right;
+    node->right = rchild->left;
+    if (rchild->left != nullptr) {
+      rchild->left->parent = node;
+    }
+    rchild->parent = node->parent;
+    replace_child(node, rchild);
+    rchild->left = node;
+    node->parent = rchild;
+  }
+  void rotate_right(Hook* node) {
+    Hook* lchild = node->left;
+    node->left = lchild->right;
+    if (lchild->right != nullptr) {
+      lchild->right->parent = node;
+    }
+    lchild->parent = node->parent;
+    replace_child(node, lchild);
+    lchild->right = node;
+    node->parent = lchild;
+  }
+  void insert_fix_up(Hook* node) {
+    Hook* parent_node = node->parent;
+    while (parent_node != nullptr && parent_node->color == Hook::red) {
+      Hook* grandparent_node = parent_node->parent;
+      bool parent_is_left = parent_node == grandparent_node->left;
+      Hook* uncle_node = parent_is_left ? grandparent_node->right :
+                                          grandparent_node->left;
+      if (!is_black(uncle_node)) {
+        parent_node->color = Hook::black;
+        uncle_node->color = Hook::black;
+        grandparent_node->color = Hook::red;
+        node = grandparent_node;
+      } else {
+        if (parent_is_left && node == parent_node->right) {
+          rotate_left(parent_node);
+          parent_node = node;
+        } else if (!parent_is_left && node == parent_node->left) {
+          rotate_right(parent_node);
+          parent_node = node;
+        }
+        parent_node->color = Hook::black;
+        grandparent_node->color = Hook::red;
+        if (parent_is_left) {
+          rotate_right(grandparent_node);
+        } else {
+          rotate_left(grandparent_node);
+        }
+        break;
+      }
+      parent_node = node->parent;
+    }
+    root_->color = Hook::black;
+  }
+  // The successor of a node with two children takes over its place and
+  // color, so no other object moves in memory or changes its links.
+  void remove(Hook* remove_node) {
+    Hook* child_node;
+    Hook* parent_node;
+    Hook::Color removed_color;
+    if (remove_node->left != nullptr && remove_node->right != nullptr) {
+      Hook* replace_node = min(remove_node->right);
+      removed_color = replace_node->color;
+      child_node = replace_node->right;
+      if (replace_node->parent == remove_node) {
+        parent_node = replace_node;
+      } else {
+        parent_node = replace_node->parent;
+        parent_node->left = child_node;
+        if (child_node != nullptr) {
+          child_node->parent = parent_node;
+        }
+        replace_node->right = remove_node->right;
+        remove_node->right->parent = replace_node;
+      }
+      replace_child(remove_node, replace_node);
+      replace_node->parent = remove_node->parent;
+      replace_node->left = remove_node->left;
+      remove_node->left->parent = replace_node;
+      replace_node->color = remove_node->color;
+    } else {
+      child_node = remove_node->left != nullptr ? remove_node->left :
+                                                  remove_node->right;
+      parent_node = remove_node->parent;
+      removed_color = remove_node->color;
+      if (child_node != nullptr) {
+        child_node->parent = parent_node;
+      }
+      replace_child(remove_node, child_node);
+    }
+    if (removed_color == Hook::black) {
+      remove_fix_up(child_node, parent_node);
+    }
+    reset(remove_node);
+    --size_;
+  }
+  void remove_fix_up(Hook* node, Hook* parent_node) {
+    while (node != root_ && is_black(node)) {
+      if (parent_node->left == node) {
+        Hook* brother_node = parent_node->right;
+        if (brother_node->color == Hook::red) {
+          brother_node->color = Hook::black;
+          parent_node->color = Hook::red;
+          rotate_left(parent_node);
+          brother_node = parent_node->right;
+        }
+        if (is_black(brother_node->left) && is_black(brother_node->right)) {
+          brother_node->color = Hook::red;
+          node = parent_node;
+          parent_node = node->parent;
+        } else {
+          if (is_black(brother_node->right)) {
+            brother_node->left->color = Hook::black;
+            brother_node->color = Hook::red;
+            rotate_right(brother_node);
+            brother_node = parent_node->right;
+          }
+          brother_node->color = parent_node->color;
+          parent_node->color = Hook::black;
+          brother_node->right->color = Hook::black;
+          rotate_left(parent_node);
+          node = root_;
+        }
+      } else {
+        Hook* brother_node = parent_node->left;
+        if (brother_node->color == Hook::red) {
+          brother_node->color = Hook::black;
+          parent_node->color = Hook::red;
+          rotate_right(parent_node);
+          brother_node = parent_node->left;
+        }
+        if (is_black(brother_node->left) && is_black(brother_node->right)) {
+          brother_node->color = Hook::red;
+          node = parent_node;
+          parent_node = node->parent;
+        } else {
+          if (is_black(brother_node->left)) {
+            brother_node->right->color = Hook::black;
+            brother_node->color = Hook::red;
+            rotate_left(brother_node);
+            brother_node = parent_node->left;
+          }
+          brother_node->color = parent_node->color;
+          parent_node->color = Hook::black;
+          brother_node->left->color = Hook::black;
+          rotate_right(parent_node);
+          node = root_;
+        }
+      }
+    }
+    if (node != nullptr) {
+      node->color = Hook::black;
+    }
+  }
+
+  void require_nonempty(const std::string& function_name) const {
+    if (empty()) {
+      throw std::out_of_range(
+        function_name + " is undefined when the tree is empty.");
+    }
+  }
+
+  size_type size_;
+  Hook* root_;
+  Compare compare_;
+};
+
+#endif  // INTRUSIVE_RB_TREE_H_
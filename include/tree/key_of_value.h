@@ -0,0 +1,53 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef KEY_OF_VALUE_H_
+#define KEY_OF_VALUE_H_
+
+#include <type_traits>
+
+// The balanced trees store values and order them by a key taken from each
+// value: the value itself in the sets, the first member in the maps.
+template <typename Tp>
+struct IdentityKey {
+  typedef Tp key_type;
+  const Tp& operator()(const Tp& value) const { return value; }
+};
+
+template <typename Pair>
+struct FirstKey {
+  typedef typename std::remove_const<typename Pair::first_type>::type
+    key_type;
+  const key_type& operator()(const Pair& value) const { return value.first; }
+};
+
+// True when Compare declares is_transparent, as std::less<> does, so that
+// lookups may pass any type the comparison accepts instead of a key.
+template <typename Compare, typename = void>
+struct IsTransparent : std::false_type {};
+template <typename Compare>
+struct IsTransparent<Compare,
+                     typename std::conditional<
+                       true, void,
+                       typename Compare::is_transparent>::type> :
+  std::true_type {};
+
+#endif  // KEY_OF_VALUE_H_
@@ -0,0 +1,289 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef NODE_SEARCH_H_
+#define NODE_SEARCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NODE_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Search within the sorted key array of a tree node.
+ *
+ * NodeSearch<Tp>::lower_bound returns the index of the first key not less
+ * than value, which is also the number of keys less than value and so the
+ * branch to descend into. For 32- and 64-bit integers, float and double on
+ * x86-64 it compares a whole vector of keys against value at once and
+ * counts the set bits of the comparison mask, stopping at the first vector
+ * that is not entirely less. AVX2 is used when the CPU has it, checked once
+ * at run time, and SSE2 otherwise; 64-bit integers need AVX2 and fall back
+ * to the scalar loop. Other arithmetic types use a branch-free scalar count,
+ * and every other type a binary search with operator<.
+ */
+template <typename Tp>
+class NodeSearch {
+public:
+  typedef std::size_t size_type;
+
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value) {
+    return lower_bound(keys, size, value, Kind());
+  }
+
+protected:
+  struct GenericKind {};
+  struct ScalarKind {};
+  struct Int32Kind {};
+  struct UInt32Kind {};
+  struct Int64Kind {};
+  struct UInt64Kind {};
+  struct FloatKind {};
+  struct DoubleKind {};
+
+  typedef typename std::conditional<
+    !std::is_arithmetic<Tp>::value || std::is_same<Tp, bool>::value,
+    GenericKind,
+    typename std::conditional<
+      std::is_same<Tp, float>::value, FloatKind,
+      typename std::conditional<
+        std::is_same<Tp, double>::value, DoubleKind,
+        typename std::conditional<
+          !std::is_integral<Tp>::value, ScalarKind,
+          typename std::conditional<
+            sizeof(Tp) == 4,
+            typename std::conditional<std::is_signed<Tp>::value,
+                                      Int32Kind, UInt32Kind>::type,
+            typename std::conditional<
+              sizeof(Tp) == 8,
+              typename std::conditional<std::is_signed<Tp>::value,
+                                        Int64Kind, UInt64Kind>::type,
+              ScalarKind>::type>::type>::type>::type>::type>::type Kind;
+
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, GenericKind) {
+    return std::lower_bound(keys, keys + size, value) - keys;
+  }
+  // Counts every key instead of stopping at the first one not less, which
+  // keeps the loop free of data-dependent branches.
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, ScalarKind) {
+    size_type count = 0;
+    for (size_type i = 0; i < size; ++i) {
+      count += keys[i] < value;
+    }
+    return count;
+  }
+
+#ifdef NODE_SEARCH_X86
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, Int32Kind) {
+    std::int32_t key = static_cast<std::int32_t>(value);
+    return finish(keys, size, value, has_avx2() ?
+                  count_avx2_int32(keys, size, key, 0) :
+                  count_sse2_int32(keys, size, key, 0));
+  }
+  // Unsigned keys are compared as signed after flipping the sign bit.
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, UInt32Kind) {
+    std::int32_t key = static_cast<std::int32_t>(
+      static_cast<std::uint32_t>(value) ^ 0x80000000u);
+    return finish(keys, size, value, has_avx2() ?
+                  count_avx2_int32(keys, size, key, INT32_MIN) :
+                  count_sse2_int32(keys, size, key, INT32_MIN));
+  }
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, Int64Kind) {
+    if (!has_avx2()) {
+      return lower_bound(keys, size, value, ScalarKind());
+    }
+    std::int64_t key = static_cast<std::int64_t>(value);
+    return finish(keys, size, value, count_avx2_int64(keys, size, key, 0));
+  }
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, UInt64Kind) {
+    if (!has_avx2()) {
+      return lower_bound(keys, size, value, ScalarKind());
+    }
+    std::int64_t key = static_cast<std::int64_t>(
+      static_cast<std::uint64_t>(value) ^ 0x8000000000000000ull);
+    return finish(keys, size, value,
+                  count_avx2_int64(keys, size, key, INT64_MIN));
+  }
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, FloatKind) {
+    return finish(keys, size, value, has_avx2() ?
+                  count_avx2_float(keys, size, value) :
+                  count_sse2_float(keys, size, value));
+  }
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, DoubleKind) {
+    return finish(keys, size, value, has_avx2() ?
+                  count_avx2_double(keys, size, value) :
+                  count_sse2_double(keys, size, value));
+  }
+
+  static bool has_avx2() {
+#ifdef __AVX2__
+    return true;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#endif
+  }
+  // The vector loops below cover whole vectors only and return how many
+  // keys they found less than value. A count short of the keys covered
+  // means the answer was found; otherwise the tail is scanned here.
+  static size_type finish(const Tp* keys, size_type size, const Tp& value,
+                          size_type count) {
+    if (count < size - size % 8) {
+      return count;
+    }
+    while (count < size && keys[count] < value) {
+      ++count;
+    }
+    return count;
+  }
+
+  // Keys are read through void pointers so that int, long and their
+  // unsigned variants all share the loops of their width.
+  static size_type count_sse2_int32(const void* keys, size_type size,
+                                    std::int32_t key, std::int32_t flip) {
+    const char* data = static_cast<const char*>(keys);
+    __m128i pivot = _mm_set1_epi32(key);
+    __m128i sign = _mm_set1_epi32(flip);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 4) {
+      __m128i block = _mm_xor_si128(sign, _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(data + i * 4)));
+      int mask = _mm_movemask_ps(
+        _mm_castsi128_ps(_mm_cmpgt_epi32(pivot, block)));
+      if (mask != 0xf) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+  static size_type count_sse2_float(const float* keys, size_type size,
+                                    float key) {
+    __m128 pivot = _mm_set1_ps(key);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 4) {
+      int mask = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(keys + i), pivot));
+      if (mask != 0xf) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+  static size_type count_sse2_double(const double* keys, size_type size,
+                                     double key) {
+    __m128d pivot = _mm_set1_pd(key);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 2) {
+      int mask = _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(keys + i), pivot));
+      if (mask != 0x3) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+
+  __attribute__((target("avx2")))
+  static size_type count_avx2_int32(const void* keys, size_type size,
+                                    std::int32_t key, std::int32_t flip) {
+    const char* data = static_cast<const char*>(keys);
+    __m256i pivot = _mm256_set1_epi32(key);
+    __m256i sign = _mm256_set1_epi32(flip);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 8) {
+      __m256i block = _mm256_xor_si256(sign, _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i * 4)));
+      int mask = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, block)));
+      if (mask != 0xff) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+  __attribute__((target("avx2")))
+  static size_type count_avx2_int64(const void* keys, size_type size,
+                                    std::int64_t key, std::int64_t flip) {
+    const char* data = static_cast<const char*>(keys);
+    __m256i pivot = _mm256_set1_epi64x(key);
+    __m256i sign = _mm256_set1_epi64x(flip);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 4) {
+      __m256i block = _mm256_xor_si256(sign, _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i * 8)));
+      int mask = _mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpgt_epi64(pivot, block)));
+      if (mask != 0xf) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+  __attribute__((target("avx2")))
+  static size_type count_avx2_float(const float* keys, size_type size,
+                                    float key) {
+    __m256 pivot = _mm256_set1_ps(key);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 8) {
+      int mask = _mm256_movemask_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(keys + i), pivot, _CMP_LT_OQ));
+      if (mask != 0xff) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+  __attribute__((target("avx2")))
+  static size_type count_avx2_double(const double* keys, size_type size,
+                                     double key) {
+    __m256d pivot = _mm256_set1_pd(key);
+    size_type covered = size - size % 8;
+    for (size_type i = 0; i < covered; i += 4) {
+      int mask = _mm256_movemask_pd(
+        _mm256_cmp_pd(_mm256_loadu_pd(keys + i), pivot, _CMP_LT_OQ));
+      if (mask != 0xf) {
+        return i + __builtin_popcount(mask);
+      }
+    }
+    return covered;
+  }
+#else
+  template <typename SimdKind>
+  static size_type lower_bound(const Tp* keys, size_type size,
+                               const Tp& value, SimdKind) {
+    return lower_bound(keys, size, value, ScalarKind());
+  }
+#endif
+};
+
+#endif  // NODE_SEARCH_H_
@@ -0,0 +1,512 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef PERSISTENT_TREE_H_
+#define PERSISTENT_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/*
+ * Persistent balanced search trees. Nodes are never modified once built:
+ * an insertion or removal copies the O(log n) nodes on the path it changes
+ * and shares every other node with the tree it started from, so copying a
+ * tree, which snapshot() does, takes O(1) and later updates to either copy
+ * leave the other as it was. Nodes are reference counted and freed once no
+ * version reaches them.
+ *
+ * One thread may update a tree while others call snapshot() on it, and
+ * each snapshot sees the tree as of some complete update. Readers should
+ * query their snapshots rather than the tree being updated; any other
+ * concurrent use needs outside synchronization.
+ */
+template <typename Tp, typename Compare, typename Alloc>
+class PersistentTreeBase {
+public:
+  typedef Tp value_type;
+  typedef std::size_t size_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
+
+  virtual ~PersistentTreeBase() {}
+
+  bool empty() const { return root_ == nullptr; }
+  size_type size() const { return size_of(root_); }
+  allocator_type get_allocator() const { return alloc_; }
+  void clear() { publish(NodePtr()); }
+
+  bool find(const Tp& value) const {
+    const Node* node = root_.get();
+    while (node != nullptr) {
+      if (compare_(value, node->value)) {
+        node = node->left.get();
+      } else if (compare_(node->value, value)) {
+        node = node->right.get();
+      } else {
+        return true;
+      }
+    }
+    return false;
+  }
+  const Tp& min() const {
+    const Node* node = require_root("PersistentTree::min()");
+    while (node->left != nullptr) {
+      node = node->left.get();
+    }
+    return node->value;
+  }
+  const Tp& max() const {
+    const Node* node = require_root("PersistentTree::max()");
+    while (node->right != nullptr) {
+      node = node->right.get();
+    }
+    return node->value;
+  }
+
+  template <typename Function>
+  void inorder(Function func) const {
+    inorder(root_.get(), func);
+  }
+
+protected:
+  struct Node;
+  typedef std::shared_ptr<const Node> NodePtr;
+  // tag is the height of the subtree in an AVL tree and the colour of the
+  // node in a red-black tree.
+  struct Node {
+    Node(const NodePtr& left, const Tp& value, const NodePtr& right,
+         unsigned char tag) :
+      value(value), left(left), right(right),
+      size(size_of(left) + 1 + size_of(right)), tag(tag) {}
+    Tp value;
+    NodePtr left;
+    NodePtr right;
+    size_type size;
+    unsigned char tag;
+  };
+
+  PersistentTreeBase(const Compare& compare, const Alloc& alloc) :
+    compare_(compare), alloc_(alloc) {}
+  PersistentTreeBase(const PersistentTreeBase& other) :
+    root_(std::atomic_load(&other.root_)), compare_(other.compare_),
+    alloc_(other.alloc_) {}
+  PersistentTreeBase(PersistentTreeBase&& other) :
+    root_(std::move(other.root_)), compare_(other.compare_),
+    alloc_(other.alloc_) {}
+  PersistentTreeBase& operator=(const PersistentTreeBase& rhs) {
+    NodePtr root = std::atomic_load(&rhs.root_);
+    compare_ = rhs.compare_;
+    alloc_ = rhs.alloc_;
+    publish(std::move(root));
+    return *this;
+  }
+  PersistentTreeBase& operator=(PersistentTreeBase&& rhs) {
+    if (this != &rhs) {
+      compare_ = rhs.compare_;
+      alloc_ = rhs.alloc_;
+      publish(std::move(rhs.root_));
+    }
+    return *this;
+  }
+
+  NodePtr make(const NodePtr& left, const Tp& value, const NodePtr& right,
+               unsigned char tag) const {
+    return std::allocate_shared<Node>(alloc_, left, value, right, tag);
+  }
+  // Only the updating thread writes root_, and it does so atomically so
+  // that snapshots taken meanwhile read either the old root or the new one.
+  void publish(NodePtr root) {
+    std::atomic_store(&root_, std::move(root));
+  }
+
+  static size_type size_of(const NodePtr& node) {
+    return node == nullptr ? 0 : node->size;
+  }
+  const Node* require_root(const char* func_name) const {
+    if (root_ == nullptr) {
+      throw std::out_of_range(std::string(func_name) +
+                              " is undefined when the tree is empty.");
+    }
+    return root_.get();
+  }
+  template <typename Function>
+  static void inorder(const Node* node, Function& func) {
+    if (node != nullptr) {
+      inorder(node->left.get(), func);
+      func(node->value);
+      inorder(node->right.get(), func);
+    }
+  }
+
+  NodePtr root_;
+  Compare compare_;
+  Alloc alloc_;
+};
+
+// Persistent AVL tree. Insertions and removals rebuild the search path
+// bottom-up, rebalancing each rebuilt node from its children's heights.
+template <typename Tp, typename Compare = std::less<Tp>,
+          typename Alloc = std::allocator<Tp>>
+class PersistentAVLTree : public PersistentTreeBase<Tp, Compare, Alloc> {
+protected:
+  typedef PersistentTreeBase<Tp, Compare, Alloc> Base;
+  typedef typename Base::Node Node;
+  typedef typename Base::NodePtr NodePtr;
+
+public:
+  PersistentAVLTree() : Base(Compare(), Alloc()) {}
+  explicit PersistentAVLTree(const Compare& compare,
+                             const Alloc& alloc = Alloc()) :
+    Base(compare, alloc) {}
+
+  PersistentAVLTree snapshot() const { return *this; }
+
+  // Each returns whether the tree changed; a value equal to one already
+  // present is not inserted.
+  bool insert(const Tp& value) {
+    bool inserted = false;
+    NodePtr root = insert(this->root_, value, inserted);
+    if (inserted) {
+      this->publish(std::move(root));
+    }
+    return inserted;
+  }
+  bool remove(const Tp& value) {
+    bool removed = false;
+    NodePtr root = remove(this->root_, value, removed);
+    if (removed) {
+      this->publish(std::move(root));
+    }
+    return removed;
+  }
+
+protected:
+  static unsigned char height(const NodePtr& node) {
+    return node == nullptr ? 0 : node->tag;
+  }
+  NodePtr node(const NodePtr& left, const Tp& value,
+               const NodePtr& right) const {
+    return this->make(left, value, right,
+                      1 + std::max(height(left), height(right)));
+  }
+  // Builds a node over subtrees whose heights differ by at most two,
+  // rotating once or twice when they differ by two.
+  NodePtr balance(const NodePtr& left, const Tp& value,
+                  const NodePtr& right) const {
+    if (height(left) > height(right) + 1) {
+      if (height(left->left) >= height(left->right)) {
+        return node(left->left, left->value,
+                    node(left->right, value, right));
+      }
+      return node(node(left->left, left->value, left->right->left),
+                  left->right->value,
+                  node(left->right->right, value, right));
+    }
+    if (height(right) > height(left) + 1) {
+      if (height(right->right) >= height(right->left)) {
+        return node(node(left, value, right->left), right->value,
+                    right->right);
+      }
+      return node(node(left, value, right->left->left), right->left->value,
+                  node(right->left->right, right->value, right->right));
+    }
+    return node(left, value, right);
+  }
+
+  // Both return sub_root itself when nothing changes below it.
+  NodePtr insert(const NodePtr& sub_root, const Tp& value,
+                 bool& inserted) const {
+    if (sub_root == nullptr) {
+      inserted = true;
+      return node(nullptr, value, nullptr);
+    }
+    if (this->compare_(value, sub_root->value)) {
+      NodePtr left = insert(sub_root->left, value, inserted);
+      return inserted ? balance(left, sub_root->value, sub_root->right) :
+                        sub_root;
+    }
+    if (this->compare_(sub_root->value, value)) {
+      NodePtr right = insert(sub_root->right, value, inserted);
+      return inserted ? balance(sub_root->left, sub_root->value, right) :
+                        sub_root;
+    }
+    return sub_root;
+  }
+  NodePtr remove(const NodePtr& sub_root, const Tp& value,
+                 bool& removed) const {
+    if (sub_root == nullptr) {
+      return sub_root;
+    }
+    if (this->compare_(value, sub_root->value)) {
+      NodePtr left = remove(sub_root->left, value, removed);
+      return removed ? balance(left, sub_root->value, sub_root->right) :
+                       sub_root;
+    }
+    if (this->compare_(sub_root->value, value)) {
+      NodePtr right = remove(sub_root->right, value, removed);
+      return removed ? balance(sub_root->left, sub_root->value, right) :
+                       sub_root;
+    }
+    removed = true;
+    if (sub_root->left == nullptr) {
+      return sub_root->right;
+    }
+    if (sub_root->right == nullptr) {
+      return sub_root->left;
+    }
+    const Node* successor = nullptr;
+    NodePtr right = remove_min(sub_root->right, successor);
+    return balance(sub_root->left, successor->value, right);
+  }
+  // The removed minimum stays alive in the old version for the caller.
+  NodePtr remove_min(const NodePtr& sub_root, const Node*& min) const {
+    if (sub_root->left == nullptr) {
+      min = sub_root.get();
+      return sub_root->right;
+    }
+    return balance(remove_min(sub_root->left, min), sub_root->value,
+                   sub_root->right);
+  }
+};
+
+// Persistent red-black tree, with insertion as in Okasaki's functional
+// red-black trees and removal as in Kahrs' "Red-black trees with types".
+template <typename Tp, typename Compare = std::less<Tp>,
+          typename Alloc = std::allocator<Tp>>
+class PersistentRBTree : public PersistentTreeBase<Tp, Compare, Alloc> {
+protected:
+  typedef PersistentTreeBase<Tp, Compare, Alloc> Base;
+  typedef typename Base::Node Node;
+  typedef typename Base::NodePtr NodePtr;
+
+public:
+  PersistentRBTree() : Base(Compare(), Alloc()) {}
+  explicit PersistentRBTree(const Compare& compare,
+                            const Alloc& alloc = Alloc()) :
+    Base(compare, alloc) {}
+
+  PersistentRBTree snapshot() const { return *this; }
+
+  // Each returns whether the tree changed; a value equal to one already
+  // present is not inserted.
+  bool insert(const Tp& value) {
+    bool inserted = false;
+    NodePtr root = insert(this->root_, value, inserted);
+    if (inserted) {
+      this->publish(blacken(root));
+    }
+    return inserted;
+  }
+  bool remove(const Tp& value) {
+    bool removed = false;
+    NodePtr root = remove(this->root_, value, removed);
+    if (removed) {
+      this->publish(blacken(root));
+    }
+    return removed;
+  }
+
+protected:
+  enum Color : unsigned char { red, black };
+
+  static bool is_red(const NodePtr& node) {
+    return node != nullptr && node->tag == red;
+  }
+  static bool is_black(const NodePtr& node) {
+    return node != nullptr && node->tag == black;
+  }
+  NodePtr red_node(const NodePtr& left, const Tp& value,
+                   const NodePtr& right) const {
+    return this->make(left, value, right, red);
+  }
+  NodePtr black_node(const NodePtr& left, const Tp& value,
+                     const NodePtr& right) const {
+    return this->make(left, value, right, black);
+  }
+  NodePtr blacken(const NodePtr& node) const {
+    return is_red(node) ? black_node(node->left, node->value, node->right) :
+                          node;
+  }
+  NodePtr redden(const NodePtr& node) const {
+    return red_node(node->left, node->value, node->right);
+  }
+
+  // Builds a black node, or resolves two reds in a row below it into a red
+  // node with two black children. Two red children are recoloured too,
+  // which removal relies on.
+  NodePtr balance(const NodePtr& left, const Tp& value,
+                  const NodePtr& right) const {
+    if (is_red(left) && is_red(right)) {
+      return red_node(blacken(left), value, blacken(right));
+    }
+    if (is_red(left)) {
+      if (is_red(left->left)) {
+        return red_node(blacken(left->left), left->value,
+                        black_node(left->right, value, right));
+      }
+      if (is_red(left->right)) {
+        return red_node(
+          black_node(left->left, left->value, left->right->left),
+          left->right->value,
+          black_node(left->right->right, value, right));
+      }
+    }
+    if (is_red(right)) {
+      if (is_red(right->right)) {
+        return red_node(black_node(left, value, right->left), right->value,
+                        blacken(right->right));
+      }
+      if (is_red(right->left)) {
+        return red_node(
+          black_node(left, value, right->left->left), right->left->value,
+          black_node(right->left->right, right->value, right->right));
+      }
+    }
+    return black_node(left, value, right);
+  }
+
+  NodePtr insert(const NodePtr& sub_root, const Tp& value,
+                 bool& inserted) const {
+    if (sub_root == nullptr) {
+      inserted = true;
+      return red_node(nullptr, value, nullptr);
+    }
+    if (this->compare_(value, sub_root->value)) {
+      NodePtr left = insert(sub_root->left, value, inserted);
+      if (!inserted) {
+        return sub_root;
+      }
+      return is_red(sub_root) ?
+             red_node(left, sub_root->value, sub_root->right) :
+             balance(left, sub_root->value, sub_root->right);
+    }
+    if (this->compare_(sub_root->value, value)) {
+      NodePtr right = insert(sub_root->right, value, inserted);
+      if (!inserted) {
+        return sub_root;
+      }
+      return is_red(sub_root) ?
+             red_node(sub_root->left, sub_root->value, right) :
+             balance(sub_root->left, sub_root->value, right);
+    }
+    return sub_root;
+  }
+
+  // Removing from a black subtree lowers its black height by one, and
+  // balance_left and balance_right restore it against the sibling.
+  // Removing from a red or empty subtree keeps its black height.
+  NodePtr remove(const NodePtr& sub_root, const Tp& value,
+                 bool& removed) const {
+    if (sub_root == nullptr) {
+      return sub_root;
+    }
+    if (this->compare_(value, sub_root->value)) {
+      NodePtr left = remove(sub_root->left, value, removed);
+      if (!removed) {
+        return sub_root;
+      }
+      return is_black(sub_root->left) ?
+             balance_left(left, sub_root->value, sub_root->right) :
+             red_node(left, sub_root->value, sub_root->right);
+    }
+    if (this->compare_(sub_root->value, value)) {
+      NodePtr right = remove(sub_root->right, value, removed);
+      if (!removed) {
+        return sub_root;
+      }
+      return is_black(sub_root->right) ?
+             balance_right(sub_root->left, sub_root->value, right) :
+             red_node(sub_root->left, sub_root->value, right);
+    }
+    removed = true;
+    return append(sub_root->left, sub_root->right);
+  }
+  // left is one black level short of right.
+  NodePtr balance_left(const NodePtr& left, const Tp& value,
+                       const NodePtr& right) const {
+    if (is_red(left)) {
+      return red_node(blacken(left), value, right);
+    }
+    if (is_black(right)) {
+      return balance(left, value, redden(right));
+    }
+    return red_node(black_node(left, value, right->left->left),
+                    right->left->value,
+                    balance(right->left->right, right->value,
+                            redden(right->right)));
+  }
+  // right is one black level short of left.
+  NodePtr balance_right(const NodePtr& left, const Tp& value,
+                        const NodePtr& right) const {
+    if (is_red(right)) {
+      return red_node(left, value, blacken(right));
+    }
+    if (is_black(left)) {
+      return balance(redden(left), value, right);
+    }
+    return red_node(balance(redden(left->left), left->value,
+                            left->right->left),
+                    left->right->value,
+                    black_node(left->right->right, value, right));
+  }
+  // Joins two subtrees of equal black height, every value in left less
+  // than every value in right.
+  NodePtr append(const NodePtr& left, const NodePtr& right) const {
+    if (left == nullptr) {
+      return right;
+    }
+    if (right == nullptr) {
+      return left;
+    }
+    if (is_red(left) && is_red(right)) {
+      NodePtr middle = append(left->right, right->left);
+      if (is_red(middle)) {
+        return red_node(red_node(left->left, left->value, middle->left),
+                        middle->value,
+                        red_node(middle->right, right->value, right->right));
+      }
+      return red_node(left->left, left->value,
+                      red_node(middle, right->value, right->right));
+    }
+    if (is_black(left) && is_black(right)) {
+      NodePtr middle = append(left->right, right->left);
+      if (is_red(middle)) {
+        return red_node(black_node(left->left, left->value, middle->left),
+                        middle->value,
+                        black_node(middle->right, right->value,
+                                   right->right));
+      }
+      return balance_left(left->left, left->value,
+                          black_node(middle, right->value, right->right));
+    }
+    if (is_red(right)) {
+      return red_node(append(left, right->left), right->value, right->right);
+    }
+    return red_node(left->left, left->value, append(left->right, right));
+  }
+};
+
+#endif  // PERSISTENT_TREE_H_
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef RB_MAP_H_
+#define RB_MAP_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "tree/key_of_value.h"
+#include "tree/rb_tree.h"
+
+/*
+ * Map from Key to Tp on a red-black tree. Lookups return a pointer to the
+ * mapped value, or nullptr when the key is absent; the pointer stays valid
+ * until that entry is removed. When Compare is transparent, find, contains
+ * and remove accept anything it can compare with a key, so a string map
+ * can be searched with a string_view without building a string.
+ *
+ * A map with an Augment other than NoAugment keeps summaries that may
+ * depend on the mapped values, so its lookups and insertions hand those
+ * values out read-only; they are changed with insert_or_assign or modify,
+ * which update the summaries above the entry.
+ */
+template <typename Key, typename Tp, typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Tp>>,
+          typename Augment = NoAugment>
+class RBMap :
+  public RBTreeBase<Key, std::pair<const Key, Tp>,
+                    FirstKey<std::pair<const Key, Tp>>, Compare, Alloc,
+                    Augment> {
+protected:
+  typedef RBTreeBase<Key, std::pair<const Key, Tp>,
+                     FirstKey<std::pair<const Key, Tp>>, Compare, Alloc,
+                     Augment> Base;
+  typedef typename Base::NodePtr NodePtr;
+
+  // Admits lookups by types other than Key only with a transparent Compare.
+  template <typename K>
+  using EnableIfTransparent =
+    typename std::enable_if<IsTransparent<Compare>::value, K>::type;
+
+public:
+  typedef Key key_type;
+  typedef Tp mapped_type;
+  // Tp, or const Tp when the map is augmented.
+  typedef typename std::conditional<std::is_same<Augment, NoAugment>::value,
+                                    Tp, const Tp>::type mapped_access;
+  typedef std::pair<const Key, Tp> value_type;
+  typedef std::size_t size_type;
+
+  RBMap() {}
+  explicit RBMap(const Compare& compare, const Alloc& alloc = Alloc()) :
+    Base(compare, alloc) {}
+  explicit RBMap(const Alloc& alloc) : Base(alloc) {}
+
+  mapped_access* find(const Key& key) { return mapped(this->search(key)); }
+  const Tp* find(const Key& key) const { return mapped(this->search(key)); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  mapped_access* find(const K& key) { return mapped(this->search(key)); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  const Tp* find(const K& key) const { return mapped(this->search(key)); }
+  bool contains(const Key& key) const {
+    return this->search(key) != nullptr;
+  }
+  template <typename K, typename = EnableIfTransparent<K>>
+  bool contains(const K& key) const { return this->search(key) != nullptr; }
+  mapped_access& at(const Key& key) {
+    return const_cast<mapped_access&>(
+      static_cast<const RBMap&>(*this).at(key));
+  }
+  const Tp& at(const Key& key) const {
+    const Tp* value = find(key);
+    if (value == nullptr) {
+      throw std::out_of_range(
+        "RBMap::at() is undefined for a key that is not in the map.");
+    }
+    return *value;
+  }
+  mapped_access& operator[](const Key& key) {
+    return *try_emplace(key).first;
+  }
+  mapped_access& operator[](Key&& key) {
+    return *try_emplace(std::move(key)).first;
+  }
+
+  // Each insertion returns the mapped value of key and whether it was
+  // inserted. insert and try_emplace leave an existing entry untouched, and
+  // try_emplace does not even move from its arguments then.
+  std::pair<mapped_access*, bool> insert(const value_type& value) {
+    return mapped(this->emplace_unique(value.first, value));
+  }
+  std::pair<mapped_access*, bool> insert(value_type&& value) {
+    return mapped(this->emplace_unique(value.first, std::move(value)));
+  }
+  template <typename... Args>
+  std::pair<mapped_access*, bool> try_emplace(const Key& key, Args&&... args) {
+    return mapped(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(key),
+      std::forward_as_tuple(std::forward<Args>(args)...)));
+  }
+  template <typename... Args>
+  std::pair<mapped_access*, bool> try_emplace(Key&& key, Args&&... args) {
+    return mapped(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...)));
+  }
+  template <typename Mapped>
+  std::pair<mapped_access*, bool> insert_or_assign(const Key& key,
+                                                   Mapped&& value) {
+    return assign(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(key),
+      std::forward_as_tuple(std::forward<Mapped>(value))),
+      std::forward<Mapped>(value));
+  }
+  template <typename Mapped>
+  std::pair<mapped_access*, bool> insert_or_assign(Key&& key,
+                                                   Mapped&& value) {
+    return assign(this->emplace_unique(
+      key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+      std::forward_as_tuple(std::forward<Mapped>(value))),
+      std::forward<Mapped>(value));
+  }
+  // Calls func(mapped value) on the entry for key, if any, then updates
+  // the summaries above it. Returns whether there was an entry.
+  template <typename Function>
+  bool modify(const Key& key, Function func) {
+    NodePtr node = this->search(key);
+    if (node == nullptr) {
+      return false;
+    }
+    func(node->value.second);
+    Base::update_path(node.get());
+    return true;
+  }
+
+  // Returns whether an entry was removed.
+  bool remove(const Key& key) { return remove_node(this->search(key)); }
+  template <typename K, typename = EnableIfTransparent<K>>
+  bool remove(const K& key) { return remove_node(this->search(key)); }
+
+  // Calls func(key, mapped value) in key order.
+  template <typename Function>
+  void traverse(Function func) {
+    this->inorder([&func](value_type& value) {
+      func(value.first, value.second);
+    });
+  }
+
+protected:
+  static Tp* mapped(const NodePtr& node) {
+    return node == nullptr ? nullptr : &node->value.second;
+  }
+  static std::pair<mapped_access*, bool> mapped(
+    const std::pair<NodePtr, bool>& result) {
+    return std::make_pair(&result.first->value.second, result.second);
+  }
+  // The entry was inserted, or is assigned value here.
+  template <typename Mapped>
+  static std::pair<mapped_access*, bool> assign(
+    const std::pair<NodePtr, bool>& result, Mapped&& value) {
+    if (!result.second) {
+      result.first->value.second = std::forward<Mapped>(value);
+      Base::update_path(result.first.get());
+    }
+    return mapped(result);
+  }
+  bool remove_node(const NodePtr& node) {
+    if (node == nullptr) {
+      return false;
+    }
+    Base::remove(this->root_, node);
+    --this->size_;
+    return true;
+  }
+};
+
+#endif  // RB_MAP_H_
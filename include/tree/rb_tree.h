@@ -22,109 +22,803 @@
 #ifndef RB_TREE_H_
 #define RB_TREE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "tree/augment.h"
+#include "tree/key_of_value.h"
+#include "tree/release_tree.h"
 
-template <typename Tp>
-class RBTree {
+
+/*
+ * Red-black tree of values ordered by the key KeyOfValue takes from each
+ * value. RBTree is the set over this base and RBMap (rb_map.h) the map.
+ * Every node also keeps the summary of its subtree that Augment defines
+ * (augment.h), which aggregate() combines over a range of keys.
+ */
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, typename Alloc, typename Augment>
+class RBTreeBase {
 public:
-  typedef Tp value_type;
-  typedef Tp& reference;
-  typedef const Tp& const_reference;
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Value& reference;
+  typedef const Value& const_reference;
   typedef std::size_t size_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
+  typedef typename Augment::summary_type summary_type;
 
-  RBTree() : size_(0), root_(nullptr) {}
-  RBTree(const RBTree& other) {
+  RBTreeBase() : size_(0), root_(nullptr) {}
+  explicit RBTreeBase(const Alloc& alloc) :
+    size_(0), root_(nullptr), alloc_(alloc) {}
+  explicit RBTreeBase(const Compare& compare, const Alloc& alloc = Alloc()) :
+    size_(0), root_(nullptr), compare_(compare), alloc_(alloc) {}
+  RBTreeBase(const RBTreeBase& other) :
+    size_(other.size_), root_(nullptr), compare_(other.compare_),
+    alloc_(std::allocator_traits<Alloc>::
+          select_on_container_copy_construction(other.alloc_)) {
     if (!other.empty()) {
-      deep_copy(root_, other.root_);
+      deep_copy(root_, other.root_, nullptr);
     }
   }
-  RBTree(RBTree&& other) : size_(std::move(other.size_)), 
-    root_(std::move(other.root_)) {}
-  RBTree& operator=(const RBTree& rhs) {
+  RBTreeBase(RBTreeBase&& other) : size_(std::move(other.size_)), 
+    root_(std::move(other.root_)), compare_(other.compare_),
+    alloc_(other.alloc_) {
+    other.size_ = 0;
+  }
+  RBTreeBase& operator=(const RBTreeBase& rhs) {
     size_type new_size = rhs.size_;
     NodePtr new_root = nullptr;
     if (!rhs.empty()) {
-      deep_copy(new_root, rhs.root_);
+      deep_copy(new_root, rhs.root_, nullptr);
     }
     clear();
     size_ = new_size;
     root_ = new_root;
+    compare_ = rhs.compare_;
     return *this;
   }
-  RBTree& operator=(RBTree&& rhs) {
+  RBTreeBase& operator=(RBTreeBase&& rhs) {
+    clear();
     size_ = std::move(rhs.size_);
     root_ = std::move(rhs.root_);
+    compare_ = rhs.compare_;
+    rhs.size_ = 0;
     return *this;
   }
-  virtual ~RBTree() {}
+  virtual ~RBTreeBase() { clear(); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
-  void clear() { size_ = 0; root_ = nullptr; }
+  allocator_type get_allocator() const { return alloc_; }
+  void clear() {
+    release(std::move(root_));
+    size_ = 0;
+  }
 
-  void insert(const value_type& value) {
-    NodePtr insert_node = std::make_shared<Node>(value);
-    insert(root_, insert_node);
-    ++size_;
+  // Replaces the contents with [first, last), which must be sorted by key.
+  // The tree is built directly in balanced shape in linear time: every
+  // node is black except those on the deepest level, which are red when
+  // that level is not the root's.
+  template <typename ForwardIterator>
+  void build_from_sorted(ForwardIterator first, ForwardIterator last) {
+    size_type count = std::distance(first, last);
+    NodePtr new_root = build_sorted(first, count, 0, deepest_level(count));
+    clear();
+    root_ = std::move(new_root);
+    size_ = count;
   }
-  void remove(const value_type& value) {
-    NodePtr remove_node = search(root_, value);
-    if (remove_node != nullptr) {
-      remove(root_, remove_node);
-      --size_;
+  // As above, building the two subtrees of every range longer than
+  // grain_size in parallel on pool, a ForkJoinPool or anything with the
+  // same invoke and fork_join. Alloc must be safe to use from the pool's
+  // threads.
+  template <typename RandomAccessIterator, typename Pool>
+  void build_from_sorted(RandomAccessIterator first, RandomAccessIterator last,
+                         Pool& pool, size_type grain_size = 4096) {
+    size_type count = last - first;
+    NodePtr new_root;
+    pool.invoke([&]() {
+      new_root = build_sorted(first, count, 0, deepest_level(count), pool,
+                              grain_size);
+    });
+    clear();
+    root_ = std::move(new_root);
+    size_ = count;
+  }
+
+  // Join-based set operations, as in AVLTreeBase. Each takes the other
+  // tree by value, so pass it with std::move to hand its nodes over
+  // instead of copying them, and keeps the value here when both trees hold
+  // a key. They treat the trees as sets and expect no key to appear twice
+  // in either. For trees of m <= n values the union, intersection and
+  // difference take O(m log(n / m + 1)) time, and their pool overloads run
+  // the two halves of every step in parallel while both sides are large
+  // compared with grain_size.
+
+  // Appends right, whose keys must all be greater than those here.
+  void join(RBTreeBase right) {
+    size_type right_size = right.size_;
+    set_root(join_subtrees(whole(), right.whole()));
+    size_ += right_size;
+  }
+  // Moves the values whose keys are not less than key into greater,
+  // replacing its contents, and returns whether key was here.
+  bool split(const Key& key, RBTreeBase& greater) {
+    Subtree less, more;
+    NodePtr equal;
+    split_subtree(whole(), key, less, equal, more);
+    bool found = equal != nullptr;
+    if (found) {
+      more = join_subtrees(Subtree(), std::move(equal), std::move(more));
     }
+    greater.clear();
+    greater.set_root(std::move(more));
+    greater.size_ = size_of(greater.root_);
+    set_root(std::move(less));
+    size_ -= greater.size_;
+    return found;
+  }
+  void union_with(RBTreeBase other) {
+    unite_trees(other, SequentialFork());
+  }
+  template <typename Pool>
+  void union_with(RBTreeBase other, Pool& pool, size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      unite_trees(other, ParallelFork<Pool>(pool, grain_size));
+    });
+  }
+  void intersect_with(RBTreeBase other) {
+    intersect_trees(other, SequentialFork());
+  }
+  template <typename Pool>
+  void intersect_with(RBTreeBase other, Pool& pool,
+                      size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      intersect_trees(other, ParallelFork<Pool>(pool, grain_size));
+    });
+  }
+  void difference_with(RBTreeBase other) {
+    subtract_trees(other, SequentialFork());
+  }
+  template <typename Pool>
+  void difference_with(RBTreeBase other, Pool& pool,
+                       size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      subtract_trees(other, ParallelFork<Pool>(pool, grain_size));
+    });
+  }
+  // Keeps only the values for which pred returns true, in linear time.
+  // The pool overload calls pred from several threads at once.
+  template <typename Predicate>
+  void filter(Predicate pred) {
+    filter_tree(pred, SequentialFork());
+  }
+  template <typename Predicate, typename Pool>
+  void filter(Predicate pred, Pool& pool, size_type grain_size = 4096) {
+    pool.invoke([&]() {
+      filter_tree(pred, ParallelFork<Pool>(pool, grain_size));
+    });
   }
 
-  bool find(const value_type& value) const {
-    return search(root_, value) != nullptr;
+  // Order statistics, in O(log n) from the subtree sizes in the nodes.
+  // select returns the value with k values before it in key order,
+  // counting from zero; rank counts the keys less than key, and
+  // count_range those not less than first and less than last.
+  const_reference select(size_type k) const {
+    if (k >= size_) {
+      throw std::out_of_range(
+        "RBTree::select() is undefined when k is not less than the size.");
+    }
+    const Node* iter = root_.get();
+    for (size_type left_size = size_of(iter->left); k != left_size;
+         left_size = size_of(iter->left)) {
+      if (k < left_size) {
+        iter = iter->left.get();
+      } else {
+        k -= left_size + 1;
+        iter = iter->right.get();
+      }
+    }
+    return iter->value;
+  }
+  size_type rank(const Key& key) const {
+    size_type less = 0;
+    for (const Node* iter = root_.get(); iter != nullptr;) {
+      if (compare_(KeyOfValue()(iter->value), key)) {
+        less += size_of(iter->left) + 1;
+        iter = iter->right.get();
+      } else {
+        iter = iter->left.get();
+      }
+    }
+    return less;
+  }
+  size_type count_range(const Key& first, const Key& last) const {
+    return compare_(first, last) ? rank(last) - rank(first) : 0;
+  }
+  // Combines the summaries of the values with keys not less than first
+  // and less than last, in key order, in O(log n): the subtrees wholly
+  // inside the range contribute the summaries kept in their roots.
+  summary_type aggregate(const Key& first, const Key& last) const {
+    const Node* top = root_.get();
+    while (top != nullptr) {
+      if (compare_(KeyOfValue()(top->value), first)) {
+        top = top->right.get();
+      } else if (!compare_(KeyOfValue()(top->value), last)) {
+        top = top->left.get();
+      } else {
+        break;
+      }
+    }
+    if (top == nullptr) {
+      throw std::out_of_range(
+        "RBTree::aggregate() is undefined when no key lies in the range.");
+    }
+    Augment augment;
+    summary_type result = augment.summarize(top->value);
+    for (const Node* iter = top->left.get(); iter != nullptr;) {
+      if (compare_(KeyOfValue()(iter->value), first)) {
+        iter = iter->right.get();
+      } else {
+        summary_type piece = augment.summarize(iter->value);
+        if (iter->right != nullptr) {
+          piece = augment.combine(piece, iter->right->summary());
+        }
+        result = augment.combine(piece, result);
+        iter = iter->left.get();
+      }
+    }
+    for (const Node* iter = top->right.get(); iter != nullptr;) {
+      if (!compare_(KeyOfValue()(iter->value), last)) {
+        iter = iter->left.get();
+      } else {
+        summary_type piece = augment.summarize(iter->value);
+        if (iter->left != nullptr) {
+          piece = augment.combine(iter->left->summary(), piece);
+        }
+        result = augment.combine(result, piece);
+        iter = iter->right.get();
+      }
+    }
+    return result;
   }
+
+  // func may change the values it is given, so afterwards the summaries
+  // of an augmented tree are all recomputed.
   void preorder(const std::function<void(value_type&)>& func) {
     preorder(root_, func);
+    refresh(root_.get(), std::is_same<Augment, NoAugment>());
   }
   void inorder(const std::function<void(value_type&)>& func) {
     inorder(root_, func);
+    refresh(root_.get(), std::is_same<Augment, NoAugment>());
   }
   void postorder(const std::function<void(value_type&)>& func) {
     postorder(root_, func);
+    refresh(root_.get(), std::is_same<Augment, NoAugment>());
   }
 
 protected:
   enum Color { red, black };
   struct Node;
   typedef std::shared_ptr<Node> NodePtr;
-  struct Node {
-    Node() : value(Tp()), parent(nullptr), left(nullptr), right(nullptr), 
-      color(black) {}
-    explicit Node(const Tp& x) : value(x), parent(nullptr), left(nullptr),
-      right(nullptr), color(black) {}
-    explicit Node(Tp&& x) : value(std::move(x)), parent(nullptr), 
-      left(nullptr), right(nullptr), color(black) {}
-    Tp value;
+  struct Node : SummarySlot<summary_type> {
+    Node() : value(Value()), parent(nullptr), left(nullptr), right(nullptr), 
+      color(black), size(1) {}
+    template <typename... Args>
+    explicit Node(Args&&... args) : value(std::forward<Args>(args)...),
+      parent(nullptr), left(nullptr), right(nullptr), color(black), size(1) {}
+    Value value;
     NodePtr parent;
     NodePtr left;
     NodePtr right;
     Color color;
+    // The number of nodes in the subtree rooted here. Their summary is
+    // kept in the SummarySlot.
+    size_type size;
+  };
+
+  // The parent links are owning, so every node sits in a reference cycle
+  // with its children and dropping the root alone would leak the tree.
+  // Each node is released with its parent link cut as well.
+  static void release(NodePtr root) {
+    release_tree(std::move(root), &Node::left, &Node::right,
+                 [](Node& node) { node.parent = nullptr; });
+  }
+
+  // Builds count nodes from the values starting at first, leaving first
+  // just past them. The middle value becomes the root and the right side
+  // gets any extra one, so all leaves lie on the last two levels and
+  // colouring only the nodes at red_depth red balances the black heights.
+  template <typename ForwardIterator>
+  NodePtr build_sorted(ForwardIterator& first, size_type count,
+                       size_type depth, size_type red_depth) {
+    if (count == 0) {
+      return nullptr;
+    }
+    size_type left_count = (count - 1) / 2;
+    NodePtr left_ptr = build_sorted(first, left_count, depth + 1, red_depth);
+    NodePtr node;
+    try {
+      node = std::allocate_shared<Node>(alloc_, *first);
+      ++first;
+      node->right = build_sorted(first, count - 1 - left_count, depth + 1,
+                                 red_depth);
+    } catch (...) {
+      release(std::move(left_ptr));
+      throw;
+    }
+    node->left = std::move(left_ptr);
+    update_node(*node);
+    link_built(node, depth, red_depth);
+    return node;
+  }
+  template <typename RandomAccessIterator, typename Pool>
+  NodePtr build_sorted(RandomAccessIterator first, size_type count,
+                       size_type depth, size_type red_depth, Pool& pool,
+                       size_type grain_size) {
+    if (count <= grain_size) {
+      return build_sorted(first, count, depth, red_depth);
+    }
+    size_type left_count = (count - 1) / 2;
+    NodePtr node = std::allocate_shared<Node>(alloc_, first[left_count]);
+    try {
+      pool.fork_join(
+        [&]() {
+          node->left = build_sorted(first, left_count, depth + 1, red_depth,
+                                    pool, grain_size);
+        },
+        [&]() {
+          node->right = build_sorted(first + (left_count + 1),
+                                     count - 1 - left_count, depth + 1,
+                                     red_depth, pool, grain_size);
+        });
+    } catch (...) {
+      release(std::move(node->left));
+      release(std::move(node->right));
+      throw;
+    }
+    update_node(*node);
+    link_built(node, depth, red_depth);
+    return node;
+  }
+  static void link_built(const NodePtr& node, size_type depth,
+                         size_type red_depth) {
+    if (node->left != nullptr) {
+      node->left->parent = node;
+    }
+    if (node->right != nullptr) {
+      node->right->parent = node;
+    }
+    node->color = depth == red_depth && depth != 0 ? red : black;
+  }
+  // The depth of the deepest level of a balanced tree of count nodes.
+  static size_type deepest_level(size_type count) {
+    size_type depth = 0;
+    for (; count > 1; count >>= 1) {
+      ++depth;
+    }
+    return depth;
+  }
+  // A detached subtree and its black height, the number of black nodes on
+  // every path from its root down. The root may be red. The join-based
+  // operations carry black heights along and derive those of the children
+  // from the colours, so no height is ever measured below the root.
+  struct Subtree {
+    Subtree() : root(nullptr), height(0) {}
+    Subtree(NodePtr root_ptr, size_type black_height) :
+      root(std::move(root_ptr)), height(black_height) {}
+    NodePtr root;
+    size_type height;
+  };
+  // Runs the two halves of a set operation one after the other.
+  struct SequentialFork {
+    template <typename Left, typename Right>
+    void operator()(size_type, const Left& left, const Right& right) const {
+      left();
+      right();
+    }
+  };
+  // Runs them in parallel on pool while the subtrees are large enough. A
+  // subtree of black height b holds at least 2^b - 1 values and fewer than
+  // 4^b.
+  template <typename Pool>
+  struct ParallelFork {
+    ParallelFork(Pool& fork_pool, size_type grain_size) :
+      pool(fork_pool), grain_height((deepest_level(grain_size) + 1) / 2) {}
+    template <typename Left, typename Right>
+    void operator()(size_type height, const Left& left,
+                    const Right& right) const {
+      if (height > grain_height) {
+        pool.fork_join(left, right);
+      } else {
+        left();
+        right();
+      }
+    }
+    Pool& pool;
+    size_type grain_height;
   };
 
-  void deep_copy(NodePtr& copy_ptr, const NodePtr& other_ptr) {
+  // Takes the nodes out as a subtree, leaving size_ to the caller.
+  Subtree whole() {
+    size_type height = 0;
+    for (Node* iter = root_.get(); iter != nullptr;
+         iter = iter->left.get()) {
+      height += iter->color == black;
+    }
+    return Subtree(std::move(root_), height);
+  }
+  void set_root(Subtree tree) {
+    root_ = std::move(tree.root);
+    if (root_ != nullptr) {
+      root_->color = black;
+    }
+  }
+  static size_type size_of(const NodePtr& node) {
+    return node == nullptr ? 0 : node->size;
+  }
+  // Recomputes the size and summary of node from its children.
+  static void update_node(Node& node) {
+    node.size = 1 + size_of(node.left) + size_of(node.right);
+    Augment augment;
+    summary_type summary = augment.summarize(node.value);
+    if (node.left != nullptr) {
+      summary = augment.combine(node.left->summary(), summary);
+    }
+    if (node.right != nullptr) {
+      summary = augment.combine(summary, node.right->summary());
+    }
+    node.set_summary(summary);
+  }
+  static void refresh(Node*, std::true_type) {}
+  static void refresh(Node* node, std::false_type) {
+    if (node != nullptr) {
+      refresh(node->left.get(), std::false_type());
+      refresh(node->right.get(), std::false_type());
+      update_node(*node);
+    }
+  }
+  // Updates node and every ancestor, after the subtree under node changed.
+  static void update_path(Node* node) {
+    for (; node != nullptr; node = node->parent.get()) {
+      update_node(*node);
+    }
+  }
+  static bool is_red(const NodePtr& node) {
+    return node != nullptr && node->color == red;
+  }
+  // Detaches the children of tree.root, cutting their parent links.
+  static void expose(Subtree& tree, Subtree& left, Subtree& right) {
+    left.height = tree.height - (tree.root->color == black ? 1 : 0);
+    right.height = left.height;
+    left.root = std::move(tree.root->left);
+    right.root = std::move(tree.root->right);
+    if (left.root != nullptr) {
+      left.root->parent = nullptr;
+    }
+    if (right.root != nullptr) {
+      right.root->parent = nullptr;
+    }
+  }
+  // Hangs left and right, of equal black height, under node, which keeps
+  // its colour.
+  static Subtree attach(NodePtr node, Subtree left, Subtree right) {
+    if (left.root != nullptr) {
+      left.root->parent = node;
+    }
+    if (right.root != nullptr) {
+      right.root->parent = node;
+    }
+    node->left = std::move(left.root);
+    node->right = std::move(right.root);
+    update_node(*node);
+    size_type height = left.height + (node->color == black);
+    return Subtree(std::move(node), height);
+  }
+  // Rotate a detached node's right or left child up into its place.
+  static NodePtr raise_right(const NodePtr& node) {
+    NodePtr top = std::move(node->right);
+    node->right = std::move(top->left);
+    if (node->right != nullptr) {
+      node->right->parent = node;
+    }
+    top->left = node;
+    node->parent = top;
+    top->parent = nullptr;
+    update_node(*node);
+    update_node(*top);
+    return top;
+  }
+  static NodePtr raise_left(const NodePtr& node) {
+    NodePtr top = std::move(node->left);
+    node->left = std::move(top->right);
+    if (node->left != nullptr) {
+      node->left->parent = node;
+    }
+    top->right = node;
+    node->parent = top;
+    top->parent = nullptr;
+    update_node(*node);
+    update_node(*top);
+    return top;
+  }
+  // Joins left, node and right, in key order. The side of greater black
+  // height is descended along its spine to a black node of the other's
+  // black height, node is hung there in red, and a red node with a red
+  // child is repaired by a rotation on the way back up.
+  static Subtree join_subtrees(Subtree left, NodePtr node, Subtree right) {
+    if (left.height > right.height) {
+      Subtree joined = join_right(std::move(left), std::move(node),
+                                  std::move(right));
+      if (is_red(joined.root) && is_red(joined.root->right)) {
+        joined.root->color = black;
+        ++joined.height;
+      }
+      return joined;
+    }
+    if (right.height > left.height) {
+      Subtree joined = join_left(std::move(left), std::move(node),
+                                 std::move(right));
+      if (is_red(joined.root) && is_red(joined.root->left)) {
+        joined.root->color = black;
+        ++joined.height;
+      }
+      return joined;
+    }
+    node->color = !is_red(left.root) && !is_red(right.root) ? red : black;
+    return attach(std::move(node), std::move(left), std::move(right));
+  }
+  static Subtree join_right(Subtree left, NodePtr node, Subtree right) {
+    if (!is_red(left.root) && left.height == right.height) {
+      node->color = red;
+      return attach(std::move(node), std::move(left), std::move(right));
+    }
+    Subtree left_left, left_right;
+    NodePtr left_node = left.root;
+    expose(left, left_left, left_right);
+    Subtree joined = attach(left_node, std::move(left_left),
+                            join_right(std::move(left_right),
+                                       std::move(node), std::move(right)));
+    if (left_node->color == black && is_red(left_node->right) &&
+        is_red(left_node->right->right)) {
+      left_node->right->right->color = black;
+      joined.root = raise_right(left_node);
+    }
+    return joined;
+  }
+  static Subtree join_left(Subtree left, NodePtr node, Subtree right) {
+    if (!is_red(right.root) && right.height == left.height) {
+      node->color = red;
+      return attach(std::move(node), std::move(left), std::move(right));
+    }
+    Subtree right_left, right_right;
+    NodePtr right_node = right.root;
+    expose(right, right_left, right_right);
+    Subtree joined = attach(right_node,
+                            join_left(std::move(left), std::move(node),
+                                      std::move(right_left)),
+                            std::move(right_right));
+    if (right_node->color == black && is_red(right_node->left) &&
+        is_red(right_node->left->left)) {
+      right_node->left->left->color = black;
+      joined.root = raise_left(right_node);
+    }
+    return joined;
+  }
+  static Subtree join_subtrees(Subtree left, Subtree right) {
+    if (left.root == nullptr) {
+      return right;
+    }
+    Subtree rest;
+    NodePtr last;
+    split_last(std::move(left), rest, last);
+    return join_subtrees(std::move(rest), std::move(last), std::move(right));
+  }
+  static void split_last(Subtree tree, Subtree& rest, NodePtr& last) {
+    Subtree left, right;
+    NodePtr node = tree.root;
+    expose(tree, left, right);
+    if (right.root == nullptr) {
+      rest = std::move(left);
+      last = std::move(node);
+      return;
+    }
+    split_last(std::move(right), rest, last);
+    rest = join_subtrees(std::move(left), std::move(node), std::move(rest));
+  }
+  // Splits tree into the values with keys less than key, a node with an
+  // equal key if any, and those with greater keys.
+  template <typename K>
+  void split_subtree(Subtree tree, const K& key, Subtree& less,
+                     NodePtr& equal, Subtree& greater) const {
+    if (tree.root == nullptr) {
+      less = Subtree();
+      equal = nullptr;
+      greater = Subtree();
+      return;
+    }
+    Subtree left, right;
+    NodePtr node = tree.root;
+    expose(tree, left, right);
+    if (compare_(key, key_of(node))) {
+      split_subtree(std::move(left), key, less, equal, greater);
+      greater = join_subtrees(std::move(greater), std::move(node),
+                              std::move(right));
+    } else if (compare_(key_of(node), key)) {
+      split_subtree(std::move(right), key, less, equal, greater);
+      less = join_subtrees(std::move(left), std::move(node), std::move(less));
+    } else {
+      less = std::move(left);
+      equal = std::move(node);
+      greater = std::move(right);
+    }
+  }
+  // Each operation below splits one tree by the root key of the other,
+  // recurses on the two pairs of halves and joins the results. Subtrees
+  // that are dropped whole go through release.
+  template <typename Fork>
+  Subtree unite(Subtree tree, Subtree other, const Fork& fork) const {
+    if (tree.root == nullptr) {
+      return other;
+    }
+    if (other.root == nullptr) {
+      return tree;
+    }
+    size_type fork_height = std::min(tree.height, other.height);
+    Subtree left, right, other_less, other_greater;
+    NodePtr node = tree.root, other_equal;
+    expose(tree, left, right);
+    split_subtree(std::move(other), key_of(node), other_less, other_equal,
+                  other_greater);
+    fork(fork_height,
+      [&]() { left = unite(std::move(left), std::move(other_less), fork); },
+      [&]() {
+        right = unite(std::move(right), std::move(other_greater), fork);
+      });
+    return join_subtrees(std::move(left), std::move(node), std::move(right));
+  }
+  template <typename Fork>
+  Subtree intersect(Subtree tree, Subtree other, const Fork& fork) const {
+    if (tree.root == nullptr || other.root == nullptr) {
+      release(std::move(tree.root));
+      release(std::move(other.root));
+      return Subtree();
+    }
+    size_type fork_height = std::min(tree.height, other.height);
+    Subtree left, right, other_less, other_greater;
+    NodePtr node = tree.root, other_equal;
+    expose(tree, left, right);
+    split_subtree(std::move(other), key_of(node), other_less, other_equal,
+                  other_greater);
+    fork(fork_height,
+      [&]() {
+        left = intersect(std::move(left), std::move(other_less), fork);
+      },
+      [&]() {
+        right = intersect(std::move(right), std::move(other_greater), fork);
+      });
+    if (other_equal == nullptr) {
+      return join_subtrees(std::move(left), std::move(right));
+    }
+    return join_subtrees(std::move(left), std::move(node), std::move(right));
+  }
+  template <typename Fork>
+  Subtree subtract(Subtree tree, Subtree other, const Fork& fork) const {
+    if (tree.root == nullptr || other.root == nullptr) {
+      release(std::move(other.root));
+      return tree;
+    }
+    size_type fork_height = std::min(tree.height, other.height);
+    Subtree other_left, other_right, less, greater;
+    NodePtr other_node = other.root, equal;
+    expose(other, other_left, other_right);
+    split_subtree(std::move(tree), key_of(other_node), less, equal, greater);
+    fork(fork_height,
+      [&]() { less = subtract(std::move(less), std::move(other_left), fork); },
+      [&]() {
+        greater = subtract(std::move(greater), std::move(other_right), fork);
+      });
+    return join_subtrees(std::move(less), std::move(greater));
+  }
+  template <typename Predicate, typename Fork>
+  Subtree filter_subtree(Subtree tree, Predicate& pred, const Fork& fork) {
+    if (tree.root == nullptr) {
+      return tree;
+    }
+    size_type fork_height = tree.height;
+    Subtree left, right;
+    NodePtr node = tree.root;
+    expose(tree, left, right);
+    fork(fork_height,
+      [&]() { left = filter_subtree(std::move(left), pred, fork); },
+      [&]() { right = filter_subtree(std::move(right), pred, fork); });
+    if (!pred(node->value)) {
+      return join_subtrees(std::move(left), std::move(right));
+    }
+    return join_subtrees(std::move(left), std::move(node), std::move(right));
+  }
+  template <typename Fork>
+  void unite_trees(RBTreeBase& other, const Fork& fork) {
+    set_root(unite(whole(), other.whole(), fork));
+    size_ = size_of(root_);
+  }
+  template <typename Fork>
+  void intersect_trees(RBTreeBase& other, const Fork& fork) {
+    set_root(intersect(whole(), other.whole(), fork));
+    size_ = size_of(root_);
+  }
+  template <typename Fork>
+  void subtract_trees(RBTreeBase& other, const Fork& fork) {
+    set_root(subtract(whole(), other.whole(), fork));
+    size_ = size_of(root_);
+  }
+  template <typename Predicate, typename Fork>
+  void filter_tree(Predicate& pred, const Fork& fork) {
+    set_root(filter_subtree(whole(), pred, fork));
+    size_ = size_of(root_);
+  }
+  void deep_copy(NodePtr& copy_ptr, const NodePtr& other_ptr,
+                 const NodePtr& parent_ptr) {
     if (other_ptr != nullptr) {
-      copy_ptr = std::make_shared<Node>(other_ptr->value);
-      deep_copy(copy_ptr->left, other_ptr->left);
-      deep_copy(copy_ptr->right, other_ptr->right);
+      copy_ptr = std::allocate_shared<Node>(alloc_, other_ptr->value);
+      copy_ptr->parent = parent_ptr;
+      copy_ptr->color = other_ptr->color;
+      copy_ptr->size = other_ptr->size;
+      copy_ptr->set_summary(other_ptr->summary());
+      deep_copy(copy_ptr->left, other_ptr->left, copy_ptr);
+      deep_copy(copy_ptr->right, other_ptr->right, copy_ptr);
     }    
   }
-  NodePtr search(const NodePtr& sub_root, const value_type& value) {
-    while (sub_root != nullptr && sub_root->value != value) {
-      if (sub_root->value > value) {
-        return search(sub_root->left, value);  
+  const Key& key_of(const NodePtr& node) const {
+    return KeyOfValue()(node->value);
+  }
+  // Accepts any type that compare_ can order against the keys.
+  template <typename K>
+  NodePtr search(const K& key) const {
+    NodePtr iter_node = root_;
+    while (iter_node != nullptr) {
+      if (compare_(key, key_of(iter_node))) {
+        iter_node = iter_node->left;
+      } else if (compare_(key_of(iter_node), key)) {
+        iter_node = iter_node->right;
       } else {
-        return search(sub_root->right, value);
+        break;
       }
     }
-    return sub_root;
+    return iter_node;
+  }
+  // Links the node built from args unless a node with an equal key is
+  // already present; the key is looked up before anything is built.
+  template <typename K, typename... Args>
+  std::pair<NodePtr, bool> emplace_unique(const K& key, Args&&... args) {
+    NodePtr parent_node = nullptr, iter_node = root_;
+    bool go_left = false;
+    while (iter_node != nullptr) {
+      parent_node = iter_node;
+      if (compare_(key, key_of(iter_node))) {
+        go_left = true;
+        iter_node = iter_node->left;
+      } else if (compare_(key_of(iter_node), key)) {
+        go_left = false;
+        iter_node = iter_node->right;
+      } else {
+        return std::make_pair(iter_node, false);
+      }
+    }
+    NodePtr insert_node = std::allocate_shared<Node>(
+      alloc_, std::forward<Args>(args)...);
+    link(root_, insert_node, parent_node, go_left);
+    ++size_;
+    return std::make_pair(insert_node, true);
   }
   void rotate_left(NodePtr& sub_root, const NodePtr& node) {
     NodePtr rchild = node->right;
@@ -144,6 +838,8 @@ protected:
     }
     rchild->left = node;
     node->parent = rchild;
+    update_node(*node);
+    update_node(*rchild);
   }
   void rotate_right(NodePtr& sub_root, const NodePtr& node) {
     NodePtr lchild = node->left;
@@ -163,27 +859,37 @@ protected:
     }
     lchild->right = node;
     node->parent = lchild;
+    update_node(*node);
+    update_node(*lchild);
   }
+  // Equal keys go to the right, after those already present.
   void insert(NodePtr& sub_root, const NodePtr& insert_node) {
     NodePtr iter_parent = nullptr, iter_node = sub_root;
+    bool go_left = false;
     while (iter_node != nullptr) {
       iter_parent = iter_node;
-      if (insert_node->value < iter_node->value) {
+      go_left = compare_(key_of(insert_node), key_of(iter_node));
+      if (go_left) {
         iter_node = iter_node->left;
       } else {
         iter_node = iter_node->right;
       }
     }
-    insert_node->parent = iter_parent;
-    if (iter_parent != nullptr) {
-      if (insert_node->value < iter_parent->value) {
-        iter_parent->left = insert_node;
+    link(sub_root, insert_node, iter_parent, go_left);
+  }
+  void link(NodePtr& sub_root, const NodePtr& insert_node,
+            const NodePtr& parent_node, bool as_left) {
+    insert_node->parent = parent_node;
+    if (parent_node != nullptr) {
+      if (as_left) {
+        parent_node->left = insert_node;
       } else {
-        iter_parent->right = insert_node;
+        parent_node->right = insert_node;
       }
     } else {
       sub_root = insert_node;
     }
+    update_path(insert_node.get());
     insert_node->color = red;
     insert_fix_up(sub_root, insert_node);
   }
@@ -259,6 +965,8 @@ protected:
     }
     return iter_node;
   }  
+  // The nodes above the position that empties are updated before the
+  // fix-up, whose rotations then keep them right.
   void remove(NodePtr& sub_root, const NodePtr& remove_node) {
     if (remove_node->left != nullptr && remove_node->right != nullptr) {
       NodePtr replace_node = min(remove_node->right);
@@ -288,6 +996,7 @@ protected:
       replace_node->left = remove_node->left;
       replace_node->color = remove_node->color;
       remove_node->left->parent = replace_node;
+      update_path(parent_node.get());
       if (replace_color == black) {
         remove_fix_up(sub_root, child_node, parent_node);
       }
@@ -312,6 +1021,7 @@ protected:
       } else {
         sub_root = child_node;
       }
+      update_path(parent_node.get());
       if (remove_color == black) {
         remove_fix_up(sub_root, child_node, parent_node);
       }
@@ -420,6 +1130,78 @@ protected:
 
   size_type size_;
   NodePtr root_;
+  Compare compare_;
+  Alloc alloc_;
+};
+
+template <typename Tp, typename Alloc = std::allocator<Tp>,
+          typename Augment = NoAugment>
+class RBTree :
+  public RBTreeBase<Tp, Tp, IdentityKey<Tp>, std::less<Tp>, Alloc, Augment> {
+public:
+  typedef Tp value_type;
+  typedef std::size_t size_type;
+
+  RBTree() {}
+  explicit RBTree(const Alloc& alloc) : Base(alloc) {}
+
+  // Equal values are all kept.
+  void insert(const value_type& value) {
+    NodePtr insert_node = std::allocate_shared<Node>(this->alloc_, value);
+    Base::insert(this->root_, insert_node);
+    ++this->size_;
+  }
+  void remove(const value_type& value) {
+    NodePtr remove_node = this->search(value);
+    if (remove_node != nullptr) {
+      Base::remove(this->root_, remove_node);
+      --this->size_;
+    }
+  }
+
+  bool find(const value_type& value) const {
+    return this->search(value) != nullptr;
+  }
+
+  // Inserts [first, last) by sorting it into a tree of its own and taking
+  // the union, which beats inserting one value at a time for large ranges.
+  // Unlike insert, it skips values already present, as union_with does.
+  // The pool overload builds that tree and the union in parallel, though
+  // the sort itself stays sequential.
+  template <typename InputIterator>
+  void insert_range(InputIterator first, InputIterator last) {
+    std::vector<value_type> values = sorted_unique(first, last);
+    RBTree range(this->alloc_);
+    range.build_from_sorted(values.begin(), values.end());
+    this->union_with(std::move(range));
+  }
+  template <typename InputIterator, typename Pool>
+  void insert_range(InputIterator first, InputIterator last, Pool& pool,
+                    size_type grain_size = 4096) {
+    std::vector<value_type> values = sorted_unique(first, last);
+    RBTree range(this->alloc_);
+    range.build_from_sorted(values.begin(), values.end(), pool, grain_size);
+    this->union_with(std::move(range), pool, grain_size);
+  }
+
+protected:
+  typedef RBTreeBase<Tp, Tp, IdentityKey<Tp>, std::less<Tp>, Alloc, Augment>
+    Base;
+  typedef typename Base::Node Node;
+  typedef typename Base::NodePtr NodePtr;
+
+  template <typename InputIterator>
+  static std::vector<value_type> sorted_unique(InputIterator first,
+                                               InputIterator last) {
+    std::vector<value_type> values(first, last);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end(),
+                             [](const value_type& lhs, const value_type& rhs) {
+                               return !(lhs < rhs);
+                             }),
+                 values.end());
+    return values;
+  }
 };
 
 #endif  // RB_TREE_H_
\ No newline at end of file
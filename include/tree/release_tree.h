@@ -0,0 +1,54 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef RELEASE_TREE_H_
+#define RELEASE_TREE_H_
+
+#include <utility>
+
+// Frees the binary tree under root without recursion. Left children are
+// rotated up until the tree is a right spine, which is then released one
+// node at a time; a degenerate tree would otherwise be freed through one
+// nested destructor call per node. before_release(node) is called on each
+// node just before it is dropped, with its left link already empty.
+template <typename Node, typename NodePtr, typename Function>
+void release_tree(NodePtr root, NodePtr Node::*left, NodePtr Node::*right,
+                  Function before_release) {
+  NodePtr iter_ptr = std::move(root);
+  while (iter_ptr != nullptr) {
+    if ((*iter_ptr).*left != nullptr) {
+      NodePtr left_ptr = std::move((*iter_ptr).*left);
+      (*iter_ptr).*left = std::move((*left_ptr).*right);
+      (*left_ptr).*right = std::move(iter_ptr);
+      iter_ptr = std::move(left_ptr);
+    } else {
+      before_release(*iter_ptr);
+      NodePtr right_ptr = std::move((*iter_ptr).*right);
+      iter_ptr = std::move(right_ptr);
+    }
+  }
+}
+template <typename Node, typename NodePtr>
+void release_tree(NodePtr root, NodePtr Node::*left, NodePtr Node::*right) {
+  release_tree(std::move(root), left, right, [](Node&) {});
+}
+
+#endif  // RELEASE_TREE_H_
@@ -0,0 +1,479 @@
+/*
+ * Copyright 2016 Waizung Taam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Create time: 2026-10-18
+ * Email: waizungtaam@gmail.com
+ */
+
+#ifndef STATIC_SEARCH_TREE_H_
+#define STATIC_SEARCH_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tree/node_search.h"
+
+/*
+ * Immutable sorted sets for read-mostly lookups, built once from a sorted
+ * range and laid out in one array so that a search follows no pointers.
+ * lower_bound returns a pointer to the least key not less than its
+ * argument, or nullptr when there is none; the pointer stays valid as long
+ * as the set does. Equal keys in the input are stored once.
+ *
+ * Besides single lookups, lower_bound and contains accept a range of
+ * queries and write one result per query to an output iterator. Queries
+ * are then run in groups, one tree level at a time across the whole group,
+ * so the cache misses of different queries overlap instead of following
+ * one another.
+ */
+template <typename Tp, typename Compare, typename Alloc>
+class StaticSearchTreeBase {
+public:
+  typedef Tp value_type;
+  typedef Tp key_type;
+  typedef std::size_t size_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
+
+  virtual ~StaticSearchTreeBase() {}
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  allocator_type get_allocator() const { return keys_.get_allocator(); }
+
+protected:
+  // Arrays start on a cache line, and a group of batch_size queries is
+  // searched together.
+  static const size_type line_size = 64;
+  static const size_type batch_size = 16;
+
+  explicit StaticSearchTreeBase(const Compare& compare, const Alloc& alloc) :
+    size_(0), offset_(0), compare_(compare), keys_(alloc) {}
+  StaticSearchTreeBase(const StaticSearchTreeBase& other) :
+    size_(other.size_), offset_(0), compare_(other.compare_),
+    keys_(std::allocator_traits<Alloc>::select_on_container_copy_construction(
+            other.keys_.get_allocator())) {
+    copy_from(other);
+  }
+  StaticSearchTreeBase(StaticSearchTreeBase&& other) :
+    size_(other.size_), offset_(other.offset_), compare_(other.compare_),
+    keys_(std::move(other.keys_)) {
+    other.size_ = 0;
+    other.offset_ = 0;
+  }
+  StaticSearchTreeBase& operator=(const StaticSearchTreeBase& rhs) {
+    if (this != &rhs) {
+      size_ = rhs.size_;
+      compare_ = rhs.compare_;
+      copy_from(rhs);
+    }
+    return *this;
+  }
+  // A move between unequal allocators copies the keys into a new array,
+  // so the array is aligned again.
+  StaticSearchTreeBase& operator=(StaticSearchTreeBase&& rhs) {
+    if (this != &rhs) {
+      const Tp* data = rhs.data();
+      keys_ = std::move(rhs.keys_);
+      size_ = rhs.size_;
+      compare_ = rhs.compare_;
+      if (keys_.data() + rhs.offset_ == data) {
+        offset_ = rhs.offset_;
+      } else {
+        realign(rhs.offset_);
+      }
+      rhs.size_ = 0;
+      rhs.offset_ = 0;
+      rhs.keys_.clear();
+    }
+    return *this;
+  }
+
+  const Tp* data() const { return keys_.data() + offset_; }
+  Tp* data() { return keys_.data() + offset_; }
+  size_type capacity() const {
+    return keys_.empty() ? 0 : keys_.size() - line_size / sizeof(Tp) - 1;
+  }
+
+  // Makes room for count keys, all copies of filler, starting on a cache
+  // line when the size of Tp divides the line.
+  void allocate(size_type count, const Tp& filler) {
+    keys_.assign(count + line_size / sizeof(Tp) + 1, filler);
+    offset_ = alignment_offset();
+  }
+  size_type alignment_offset() const {
+    if (line_size % sizeof(Tp) != 0) {
+      return 0;
+    }
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(keys_.data());
+    return (line_size - address % line_size) % line_size / sizeof(Tp);
+  }
+  // Moves the keys, found offset slots into the array, onto a cache line.
+  void realign(size_type offset) {
+    if (keys_.empty()) {
+      offset_ = 0;
+      return;
+    }
+    std::vector<Tp, Alloc> keys(keys_.get_allocator());
+    keys.swap(keys_);
+    allocate(keys.size() - line_size / sizeof(Tp) - 1, keys.back());
+    std::copy(keys.begin() + offset, keys.begin() + offset + capacity(),
+              data());
+  }
+  void copy_from(const StaticSearchTreeBase& other) {
+    if (other.keys_.empty()) {
+      keys_.clear();
+      offset_ = 0;
+      return;
+    }
+    allocate(other.capacity(), other.keys_.back());
+    std::copy(other.data(), other.data() + other.capacity(), data());
+  }
+
+  // Copies the sorted range, keeping one of each run of equal keys.
+  template <typename ForwardIt>
+  std::vector<Tp, Alloc> sorted_unique(ForwardIt first, ForwardIt last) const {
+    std::vector<Tp, Alloc> sorted(keys_.get_allocator());
+    sorted.reserve(std::distance(first, last));
+    for (; first != last; ++first) {
+      if (sorted.empty() || compare_(sorted.back(), *first)) {
+        sorted.push_back(*first);
+      }
+    }
+    return sorted;
+  }
+
+  // Hints that the key at data + index will be read soon. The address is
+  // computed as an integer since it may lie past the end of the array.
+  static void prefetch(const Tp* data, size_type index) {
+#if defined(__GNUC__)
+    __builtin_prefetch(reinterpret_cast<const void*>(
+      reinterpret_cast<std::uintptr_t>(data) + index * sizeof(Tp)));
+#else
+    (void)data;
+    (void)index;
+#endif
+  }
+
+  bool equals(const Tp* key, const Tp& value) const {
+    return key != nullptr && !compare_(value, *key);
+  }
+
+  size_type size_;
+  size_type offset_;
+  Compare compare_;
+  std::vector<Tp, Alloc> keys_;
+};
+
+/*
+ * Static sorted set in Eytzinger order: the keys of a complete binary
+ * search tree stored level by level, the children of the key at index k
+ * (from 1) at 2k and 2k + 1. The first levels stay in cache, the descent is
+ * free of branches, and the 16 descendants four levels below a key of four
+ * bytes share a cache line, which is prefetched while the levels between
+ * are searched.
+ */
+template <typename Tp, typename Compare = std::less<Tp>,
+          typename Alloc = std::allocator<Tp>>
+class EytzingerTree : public StaticSearchTreeBase<Tp, Compare, Alloc> {
+protected:
+  typedef StaticSearchTreeBase<Tp, Compare, Alloc> Base;
+
+public:
+  typedef typename Base::size_type size_type;
+
+  EytzingerTree() : Base(Compare(), Alloc()), height_(0) {}
+  explicit EytzingerTree(const Compare& compare,
+                         const Alloc& alloc = Alloc()) :
+    Base(compare, alloc), height_(0) {}
+  // The range must be sorted by compare.
+  template <typename ForwardIt>
+  EytzingerTree(ForwardIt first, ForwardIt last,
+                const Compare& compare = Compare(),
+                const Alloc& alloc = Alloc()) :
+    Base(compare, alloc), height_(0) {
+    build(this->sorted_unique(first, last));
+  }
+
+  const Tp* lower_bound(const Tp& value) const {
+    const Tp* keys = this->data();
+    size_type k = 1;
+    while (k <= this->size_) {
+      Base::prefetch(keys, k * prefetch_stride);
+      k = 2 * k + this->compare_(keys[k], value);
+    }
+    return result(k);
+  }
+  bool contains(const Tp& value) const {
+    return this->equals(lower_bound(value), value);
+  }
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt lower_bound(ForwardIt first, ForwardIt last,
+                       OutputIt result) const {
+    search_batch(first, last, [&result](const Tp&, const Tp* key) {
+      *result++ = key;
+    });
+    return result;
+  }
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt contains(ForwardIt first, ForwardIt last, OutputIt result) const {
+    search_batch(first, last, [this, &result](const Tp& value,
+                                              const Tp* key) {
+      *result++ = this->equals(key, value);
+    });
+    return result;
+  }
+
+protected:
+  // Index distance to the descendants prefetched: the largest power of two
+  // whose keys fit in a cache line, and at least the grandchildren.
+  static constexpr size_type stride(size_type count) {
+    return count * 2 * sizeof(Tp) > Base::line_size || count >= 64 ?
+           count : stride(count * 2);
+  }
+  static const size_type prefetch_stride = stride(4);
+
+  // Each key is placed by an in-order walk of the implicit tree.
+  void build(const std::vector<Tp, Alloc>& sorted) {
+    this->size_ = sorted.size();
+    if (sorted.empty()) {
+      return;
+    }
+    this->allocate(this->size_ + 1, sorted.front());
+    fill(sorted, 0, 1);
+    for (size_type k = this->size_; k > 0; k /= 2) {
+      ++height_;
+    }
+  }
+  size_type fill(const std::vector<Tp, Alloc>& sorted, size_type i,
+                 size_type k) {
+    if (k <= this->size_) {
+      i = fill(sorted, i, 2 * k);
+      this->data()[k] = sorted[i++];
+      i = fill(sorted, i, 2 * k + 1);
+    }
+    return i;
+  }
+
+  // The bits of k below its leading one record the turns taken, 1 for
+  // right. Dropping the trailing right turns and the last left turn leaves
+  // the last key found not less than the value, or 0 for none.
+  const Tp* result(size_type k) const {
+#if defined(__GNUC__)
+    k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+#else
+    while (k & 1) {
+      k >>= 1;
+    }
+    k >>= 1;
+#endif
+    return k == 0 ? nullptr : this->data() + k;
+  }
+
+  // Every query needs one step per level but possibly the last, so the
+  // whole group advances level by level.
+  template <typename ForwardIt, typename Function>
+  void search_batch(ForwardIt first, ForwardIt last, Function func) const {
+    const Tp* keys = this->data();
+    ForwardIt values[Base::batch_size];
+    size_type indices[Base::batch_size];
+    while (first != last) {
+      size_type count = 0;
+      for (; count < Base::batch_size && first != last; ++count, ++first) {
+        values[count] = first;
+        indices[count] = 1;
+      }
+      for (size_type level = 0; level < height_; ++level) {
+        for (size_type i = 0; i < count; ++i) {
+          size_type k = indices[i];
+          if (k <= this->size_) {
+            Base::prefetch(keys, k * prefetch_stride);
+            indices[i] = 2 * k + this->compare_(keys[k], *values[i]);
+          }
+        }
+      }
+      for (size_type i = 0; i < count; ++i) {
+        func(*values[i], result(indices[i]));
+      }
+    }
+  }
+
+  size_type height_;
+};
+
+/*
+ * Static sorted set as an S-tree: a B-tree of blocks of block_size keys,
+ * each block one cache line for keys of four or eight bytes, stored in one
+ * array in breadth-first order so that the children of block k are blocks
+ * k * (block_size + 1) + 1 through k * (block_size + 1) + block_size + 1
+ * and need no pointers. A lookup reads one cache line per level, a factor
+ * of about log2(block_size) fewer than a binary tree, and with the default
+ * comparison searches each block with NodeSearch, which compares a vector
+ * of keys at once. Slots past the last key hold copies of it, which keeps
+ * every block sorted and full.
+ */
+template <typename Tp, typename Compare = std::less<Tp>,
+          typename Alloc = std::allocator<Tp>>
+class STree : public StaticSearchTreeBase<Tp, Compare, Alloc> {
+protected:
+  typedef StaticSearchTreeBase<Tp, Compare, Alloc> Base;
+
+public:
+  typedef typename Base::size_type size_type;
+
+  static const size_type block_size = sizeof(Tp) <= 4 ? 16 : 8;
+
+  STree() : Base(Compare(), Alloc()), height_(0) {}
+  explicit STree(const Compare& compare, const Alloc& alloc = Alloc()) :
+    Base(compare, alloc), height_(0) {}
+  // The range must be sorted by compare.
+  template <typename ForwardIt>
+  STree(ForwardIt first, ForwardIt last, const Compare& compare = Compare(),
+        const Alloc& alloc = Alloc()) :
+    Base(compare, alloc), height_(0) {
+    build(this->sorted_unique(first, last));
+  }
+
+  const Tp* lower_bound(const Tp& value) const {
+    const Tp* keys = this->data();
+    const Tp* found = nullptr;
+    for (size_type k = 0; k < blocks(); ) {
+      k = step(keys, k, value, found);
+    }
+    return found;
+  }
+  bool contains(const Tp& value) const {
+    return this->equals(lower_bound(value), value);
+  }
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt lower_bound(ForwardIt first, ForwardIt last,
+                       OutputIt result) const {
+    search_batch(first, last, [&result](const Tp&, const Tp* key) {
+      *result++ = key;
+    });
+    return result;
+  }
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt contains(ForwardIt first, ForwardIt last, OutputIt result) const {
+    search_batch(first, last, [this, &result](const Tp& value,
+                                              const Tp* key) {
+      *result++ = this->equals(key, value);
+    });
+    return result;
+  }
+
+protected:
+  size_type blocks() const {
+    return (this->size_ + block_size - 1) / block_size;
+  }
+  static size_type child(size_type k, size_type index) {
+    return k * (block_size + 1) + index + 1;
+  }
+
+  // Keys are placed by an in-order walk of the implicit tree; the slots
+  // left over at the end of the walk keep the largest key.
+  void build(const std::vector<Tp, Alloc>& sorted) {
+    this->size_ = sorted.size();
+    if (sorted.empty()) {
+      return;
+    }
+    this->allocate(blocks() * block_size, sorted.back());
+    size_type i = 0;
+    fill(sorted, i, 0);
+    for (size_type k = blocks() - 1; ; k = (k - 1) / (block_size + 1)) {
+      ++height_;
+      if (k == 0) {
+        break;
+      }
+    }
+  }
+  void fill(const std::vector<Tp, Alloc>& sorted, size_type& i, size_type k) {
+    if (k >= blocks()) {
+      return;
+    }
+    Tp* block = this->data() + k * block_size;
+    for (size_type j = 0; j < block_size; ++j) {
+      fill(sorted, i, child(k, j));
+      if (i < sorted.size()) {
+        block[j] = sorted[i++];
+      }
+    }
+    fill(sorted, i, child(k, block_size));
+  }
+
+  // Searches block k, records its first key not less than value, and
+  // returns the block to descend into.
+  size_type step(const Tp* keys, size_type k, const Tp& value,
+                 const Tp*& found) const {
+    const Tp* block = keys + k * block_size;
+    size_type index = block_index(block, value,
+                                  std::is_same<Compare, std::less<Tp>>());
+    if (index < block_size) {
+      found = block + index;
+    }
+    return child(k, index);
+  }
+  size_type block_index(const Tp* block, const Tp& value,
+                        std::true_type) const {
+    return NodeSearch<Tp>::lower_bound(block, block_size, value);
+  }
+  size_type block_index(const Tp* block, const Tp& value,
+                        std::false_type) const {
+    return std::lower_bound(block, block + block_size, value,
+                            this->compare_) - block;
+  }
+
+  // A query is done once it steps past the last block; the group advances
+  // level by level, each query prefetching its next block as it goes.
+  template <typename ForwardIt, typename Function>
+  void search_batch(ForwardIt first, ForwardIt last, Function func) const {
+    const Tp* keys = this->data();
+    ForwardIt values[Base::batch_size];
+    size_type indices[Base::batch_size];
+    const Tp* found[Base::batch_size];
+    while (first != last) {
+      size_type count = 0;
+      for (; count < Base::batch_size && first != last; ++count, ++first) {
+        values[count] = first;
+        indices[count] = 0;
+        found[count] = nullptr;
+      }
+      for (size_type level = 0; level < height_; ++level) {
+        for (size_type i = 0; i < count; ++i) {
+          if (indices[i] < blocks()) {
+            indices[i] = step(keys, indices[i], *values[i], found[i]);
+            Base::prefetch(keys, indices[i] * block_size);
+          }
+        }
+      }
+      for (size_type i = 0; i < count; ++i) {
+        func(*values[i], found[i]);
+      }
+    }
+  }
+
+  size_type height_;
+};
+
+#endif  // STATIC_SEARCH_TREE_H_